@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "access.h"
+#include "dialogreply.h"
+#include "utils.h"
 
 #include <sys/types.h>
 #include <unistd.h>
@@ -27,33 +29,33 @@ uint AccessPortal::AccessDialog(
 {
     qCDebug(XdgDestkopDDEAccess) << "request for access dialog";
 
-    QMessageBox access_dialog;
-
-    if (options.contains(QStringLiteral("modal"))) {
-        access_dialog.setModal(options.value(QStringLiteral("modal")).toBool());
-    }
+    auto access_dialog = new QMessageBox;
+    Utils::setParentWindow(access_dialog, parent_window);
 
     QPushButton *rejectButton = nullptr;
     if (options.contains(QStringLiteral("deny_label"))) {
-        rejectButton = access_dialog.addButton(options.value(QStringLiteral("deny_label")).toString(), QMessageBox::RejectRole);
+        rejectButton = access_dialog->addButton(options.value(QStringLiteral("deny_label")).toString(), QMessageBox::RejectRole);
     }
 
 
     QPushButton *allowButton = nullptr;
     if (options.contains(QStringLiteral("grant_label"))) {
-        allowButton = access_dialog.addButton(options.value(QStringLiteral("grant_label")).toString(), QMessageBox::AcceptRole);
-    }
-
-    access_dialog.setWindowTitle(title);
-    access_dialog.setText(body);
-    access_dialog.exec();
-
-    uint respnse = 2;
-    if (access_dialog.clickedButton() == (QAbstractButton*)rejectButton) {
-        respnse = 0;
-    } else if (access_dialog.clickedButton() == (QAbstractButton*)allowButton) {
-        respnse = 1;
+        allowButton = access_dialog->addButton(options.value(QStringLiteral("grant_label")).toString(), QMessageBox::AcceptRole);
     }
 
-    return respnse;
+    access_dialog->setWindowTitle(title);
+    access_dialog->setText(body);
+
+    const bool modal = options.value(QStringLiteral("modal"), true).toBool();
+    DialogReply::show(this, handle, access_dialog, modal, [access_dialog, rejectButton, allowButton](int, QVariantMap &) -> uint {
+        uint respnse = 2;
+        if (access_dialog->clickedButton() == (QAbstractButton*)rejectButton) {
+            respnse = 0;
+        } else if (access_dialog->clickedButton() == (QAbstractButton*)allowButton) {
+            respnse = 1;
+        }
+        return respnse;
+    });
+
+    return 0;
 }
@@ -12,6 +12,10 @@
 #include <QDBusMessage>
 #include <QDBusPendingReply>
 #include <QDBusConnection>
+#include <QUrl>
+
+#include "dbushelpers.h"
+#include "request.h"
 
 Q_LOGGING_CATEGORY(XdgDestkopDDEAcount, "xdg-dde-account")
 
@@ -32,30 +36,50 @@ uint AccountPortal::GetUserInformation(
         reason = options.value(QStringLiteral("reason")).toString();
     }
 
+    auto context = dbusContext(this);
+    if (!context) {
+        qCWarning(XdgDestkopDDEAcount) << "Failed to get dbus context";
+        return 2;
+    }
+    // Answered once AccountsService replied, or right away when the request is closed
+    context->setDelayedReply(true);
+    const QDBusMessage message = context->message();
+    auto request = new Request(handle, QVariant(), this);
+    const CancellationToken token = request->token();
+    connect(request, &Request::closeRequested, this, [message] {
+        QDBusConnection::sessionBus().send(message.createReply({ 2u, QVariantMap() }));
+    });
+
     QString idUserPath = QStringLiteral("/org/freedesktop/Accounts/User%1").arg(getuid());
-    QDBusMessage UserMsg = QDBusMessage::createMethodCall(QStringLiteral("org.freedesktop.Accounts"),
-                                                             idUserPath,
-                                                             QStringLiteral("org.freedesktop.DBus.Properties"),
-                                                             QStringLiteral("Get"));
-
-    UserMsg.setArguments({QVariant::fromValue(QStringLiteral("org.freedesktop.Accounts.User")), QVariant::fromValue(QStringLiteral("IconFile"))});
-    QDBusPendingReply<QDBusVariant> iconReply = QDBusConnection::systemBus().call(UserMsg);
-    if (iconReply.isError())
-        qCDebug(XdgDestkopDDEAcount) << "setting failed";
-
-    UserMsg.setArguments({QVariant::fromValue(QStringLiteral("org.freedesktop.Accounts.User")), QVariant::fromValue(QStringLiteral("RealName"))});
-    QDBusPendingReply<QDBusVariant> realNameReply = QDBusConnection::systemBus().call(UserMsg);
-    if (realNameReply.isError())
-        qCDebug(XdgDestkopDDEAcount) << "setting failed";
-
-    UserMsg.setArguments({QVariant::fromValue(QStringLiteral("org.freedesktop.Accounts.User")), QVariant::fromValue(QStringLiteral("UserName"))});
-    QDBusPendingReply<QDBusVariant> userNameReply = QDBusConnection::systemBus().call(UserMsg);
-    if (userNameReply.isError())
-        qCDebug(XdgDestkopDDEAcount) << "setting failed";
-
-    results.insert(QStringLiteral("id"), userNameReply.value().variant().toString());
-    results.insert(QStringLiteral("name"), iconReply.value().variant().toString());
-    results.insert(QStringLiteral("image"), realNameReply.value().variant().toString());
-
-    return !results.isEmpty();
+    QDBusMessage userMsg = QDBusMessage::createMethodCall(QStringLiteral("org.freedesktop.Accounts"),
+                                                          idUserPath,
+                                                          QStringLiteral("org.freedesktop.DBus.Properties"),
+                                                          QStringLiteral("GetAll"));
+    userMsg.setArguments({ QVariant::fromValue(QStringLiteral("org.freedesktop.Accounts.User")) });
+
+    auto watcher = new QDBusPendingCallWatcher(QDBusConnection::systemBus().asyncCall(userMsg), request);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, message, token, request](QDBusPendingCallWatcher *watcher) {
+        // A closed request has been answered already, its result is of no use
+        if (token.isCancelled())
+            return;
+        disconnect(request, nullptr, this, nullptr);
+        request->deleteLater();
+
+        QDBusPendingReply<QVariantMap> reply = *watcher;
+        if (reply.isError()) {
+            qCDebug(XdgDestkopDDEAcount) << "setting failed" << reply.error().message();
+            QDBusConnection::sessionBus().send(message.createReply({ 2u, QVariantMap() }));
+            return;
+        }
+
+        const QVariantMap properties = reply.value();
+        QVariantMap information;
+        information.insert(QStringLiteral("id"), properties.value(QStringLiteral("UserName")).toString());
+        information.insert(QStringLiteral("name"), properties.value(QStringLiteral("RealName")).toString());
+        const QString iconFile = properties.value(QStringLiteral("IconFile")).toString();
+        information.insert(QStringLiteral("image"), iconFile.isEmpty() ? QString() : QUrl::fromLocalFile(iconFile).toString());
+        QDBusConnection::sessionBus().send(message.createReply({ 0u, information }));
+    });
+
+    return 0;
 }
@@ -4,7 +4,10 @@
 
 #include "appchooser.h"
 #include "appchooserdialog.h"
-#include "request.h"
+#include "applicationindex.h"
+#include "appsearchindex.h"
+#include "mimehandlerindex.h"
+#include "dialogreply.h"
 #include "utils.h"
 
 #include <QDBusConnection>
@@ -13,16 +16,46 @@
 #include <QLoggingCategory>
 
 Q_LOGGING_CATEGORY(appChooserCategory, "xdg-dde-appchooser")
+
+namespace {
+struct ChooseApplicationOptions
+{
+    // The app id that was selected the last time.
+    QString last_choice;
+    // Whether to make the dialog modal. Defaults to yes.
+    bool modal = true;
+    // The content type to choose an application for.
+    QString content_type;
+    // The uri to choose an application for.
+    QString uri;
+    // The filename to choose an application for. Note that this is just a basename, without a path.
+    QString filename;
+    // A token that can be used to activate the application chooser.
+    // The activation_token option was introduced in version 2 of the interface.
+    QString activation_token;
+};
+
+constexpr auto ChooseApplicationSchema = std::make_tuple(optionKey("last_choice", &ChooseApplicationOptions::last_choice),
+                                                         optionKey("modal", &ChooseApplicationOptions::modal),
+                                                         optionKey("content_type", &ChooseApplicationOptions::content_type),
+                                                         optionKey("uri", &ChooseApplicationOptions::uri),
+                                                         optionKey("filename", &ChooseApplicationOptions::filename),
+                                                         optionKey("activation_token", &ChooseApplicationOptions::activation_token));
+} // namespace
+
 AppChooserPortal::AppChooserPortal(QObject *parent)
     : QDBusAbstractAdaptor(parent)
 {
+    // Enumerate in the background, dialogs then open with the index ready
+    ApplicationIndex::instance()->load();
+
 #ifdef QT_DEBUG
     QVariantMap results;
     QVariantMap options;
     options.insert("modal", true);
     options.insert("content_type", "title");
+    // Not called from D-Bus, the result is logged once the dialog finished
     ChooseApplication(QDBusObjectPath(), "", "", QStringList(), options, results);
-    qDebug() << results;
 #endif
 }
 
@@ -39,43 +72,37 @@ uint AppChooserPortal::ChooseApplication(const QDBusObjectPath &handle, const QS
                                 << "\n choices:" << choices
                                 << "\n options:" << options;
 
-    Q_UNUSED(choices);
-    // The app id that was selected the last time.
-    DECLEAR_PARA(last_choice, toString);
-    // Whether to make the dialog modal. Defaults to yes.
-    DECLEAR_PARA_WITH_FALLBACK(modal, toBool, true);
-    // The content type to choose an application for.
-    DECLEAR_PARA(content_type, toString);
-    // The uri to choose an application for.
-    DECLEAR_PARA(uri, toString);
-    // The filename to choose an application for. Note that this is just a basename, without a path.
-    DECLEAR_PARA(filename, toString);
-    // A token that can be used to activate the application chooser.
-    // The activation_token option was introduced in version 2 of the interface.
-    DECLEAR_PARA(activation_token, toString);
-    Q_UNUSED(activation_token)
+    const auto opts = decodeOptions<ChooseApplicationOptions>(options, ChooseApplicationSchema);
+
+    // The apps the frontend found first, then whatever else handles the type
+    QStringList preferredApps = choices;
+    const QString contentType = MimeHandlerIndex::contentType(opts.content_type, opts.uri, opts.filename);
+    for (const QString &appId : MimeHandlerIndex::instance()->handlers(contentType)) {
+        if (!preferredApps.contains(appId))
+            preferredApps.append(appId);
+    }
 
     AppChooserDialog *dialog = new AppChooserDialog;
-    dialog->setModal(modal);
-    dialog->setWindowTitle(!content_type.isEmpty() ? content_type : (!uri.isEmpty() ? uri : filename));
-    dialog->setCurrentChoice(last_choice);
+    dialog->setWindowTitle(!opts.content_type.isEmpty() ? opts.content_type : (!opts.uri.isEmpty() ? opts.uri : opts.filename));
+    dialog->setPreferredApps(preferredApps);
+    dialog->setCurrentChoice(opts.last_choice);
 
     m_appChooserDialogs.insert(handle.path(), dialog);
     Utils::setParentWindow(dialog->windowHandle(), parent_window);
 
-    auto request = new Request(handle, QVariant(), dialog);
-    connect(request, &Request::closeRequested, dialog, &AppChooserDialog::reject);
-
-    int result = dialog->exec();
-
-    if (QDialog::Accepted == result) {
-        results.insert(QStringLiteral("choice"), dialog->selectChoices());
-    }
+    const QString path = handle.path();
+    DialogReply::show(this, handle, dialog, opts.modal, [this, dialog, path](int result, QVariantMap &results) -> uint {
+        m_appChooserDialogs.remove(path);
+        if (QDialog::Accepted != result)
+            return 1;
 
-    m_appChooserDialogs.remove(handle.path());
-    dialog->deleteLater();
+        const QStringList selected = dialog->selectChoices();
+        AppSearchIndex::recordUsage(selected);
+        results.insert(QStringLiteral("choice"), selected);
+        return 0;
+    });
 
-    return !result;
+    return 0;
 }
 
 void AppChooserPortal::UpdateChoices(const QDBusObjectPath &handle, const QStringList &choices)
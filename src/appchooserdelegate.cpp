@@ -4,6 +4,7 @@
 
 #include "appchooserdelegate.h"
 #include "appchoosermodel.h"
+#include "iconcache.h"
 
 #include <QPainter>
 #include <QDebug>
@@ -27,8 +28,18 @@ void AppChooserDelegate::paint(QPainter *painter, const QStyleOptionViewItem &op
 
     // draw icon
     QRect iconRect = QRect(option.rect.x(), option.rect.y(), 40, 40);
-    QPixmap pix = QIcon::fromTheme(icon).pixmap(40, 40);
-    painter->drawPixmap(iconRect, pix);
+    const QPixmap pix = IconCache::instance()->pixmap(icon, 40, painter->device()->devicePixelRatioF());
+    if (pix.isNull()) {
+        // Placeholder until the cache has the icon, the view repaints then
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(option.palette.midlight());
+        painter->drawRoundedRect(iconRect.adjusted(4, 4, -4, -4), 6, 6);
+        painter->restore();
+    } else {
+        painter->drawPixmap(iconRect, pix);
+    }
 
     // draw name
     QRect nameRect = QRect(option.rect.x() + 40, option.rect.y(), option.rect.width() - iconRect.width(), option.rect.height());
@@ -5,8 +5,11 @@
 #include "appchooserdialog.h"
 #include "appchoosermodel.h"
 #include "appchooserdelegate.h"
+#include "appchooserfiltermodel.h"
+#include "appgridview.h"
+#include "iconcache.h"
 
-#include <QListView>
+#include <QLineEdit>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -14,32 +17,39 @@
 
 AppChooserDialog::AppChooserDialog(QWidget *parent)
     : QDialog(parent)
-    , m_view(new QListView(this))
+    , m_searchEdit(new QLineEdit(this))
+    , m_view(new AppGridView(this))
+    , m_model(new AppChooserModel(this))
+    , m_filterModel(new AppChooserFilterModel(this))
     , m_cancelBtn(new QPushButton(tr("Cancel"), this))
     , m_confirmBtn(new QPushButton(tr("Confirm"), this))
 {
-    m_view->setFlow(QListView::LeftToRight);
-    m_view->setWrapping(true);
-    m_view->setResizeMode(QListView::Adjust);
-    m_view->setSelectionMode(QListView::MultiSelection);
-    m_view->setSelectionRectVisible(true);
+    m_view->setSelectionMode(QAbstractItemView::MultiSelection);
     m_view->setAlternatingRowColors(true);
-    m_view->setEditTriggers(QListView::NoEditTriggers);
-    connect(m_view, &QListView::clicked, this, [ = ] (const QModelIndex &index) {
-        if (auto model = qobject_cast<AppChooserModel *>(m_view->model()))
-            model->click(index);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    // The cell size comes from the delegate, set it before any row shows up
+    m_view->setItemDelegate(new AppChooserDelegate(m_view));
+    connect(m_view, &AppGridView::clicked, this, [ = ] (const QModelIndex &index) {
+        m_model->click(m_filterModel->mapToSource(index));
     });
 
+    m_searchEdit->setPlaceholderText(tr("Search"));
+    m_searchEdit->setClearButtonEnabled(true);
+    connect(m_searchEdit, &QLineEdit::textChanged, m_filterModel, &AppChooserFilterModel::setFilterText);
+
     QHBoxLayout *btnLayout = new QHBoxLayout;
     btnLayout->setAlignment(Qt::AlignRight);
     btnLayout->addWidget(m_cancelBtn);
     btnLayout->addWidget(m_confirmBtn);
 
     QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(m_searchEdit);
     layout->addWidget(m_view);
     layout->addLayout(btnLayout, 0);
-    m_view->setModel(new AppChooserModel);
-    m_view->setItemDelegate(new AppChooserDelegate);
+    m_filterModel->setSourceModel(m_model);
+    m_view->setModel(m_filterModel);
+    // Icons arriving in a burst are painted with a single update
+    connect(IconCache::instance(), &IconCache::iconReady, m_view->viewport(), qOverload<>(&QWidget::update));
 
     connect(m_confirmBtn, &QPushButton::clicked, this, &QDialog::accept);
     connect(m_cancelBtn, &QPushButton::clicked, this, &QDialog::reject);
@@ -49,11 +59,7 @@ AppChooserDialog::AppChooserDialog(QWidget *parent)
 
 QStringList AppChooserDialog::selectChoices()
 {
-    auto model = qobject_cast<AppChooserModel *>(m_view->model());
-    if (model) {
-        return model->choices();
-    }
-    return QStringList();
+    return m_model->choices();
 }
 
 void AppChooserDialog::updateChoices(const QStringList &choices)
@@ -63,10 +69,12 @@ void AppChooserDialog::updateChoices(const QStringList &choices)
     // unused
 }
 
+void AppChooserDialog::setPreferredApps(const QStringList &appIds)
+{
+    m_model->setPreferredApps(appIds);
+}
+
 void AppChooserDialog::setCurrentChoice(const QString &choice)
 {
-    auto model = qobject_cast<AppChooserModel *>(m_view->model());
-    if (model) {
-        model->click(choice);
-    }
+    m_model->click(choice);
 }
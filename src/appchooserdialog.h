@@ -7,7 +7,10 @@
 #include <QDialog>
 #include <QStringList>
 
-class QListView;
+class AppChooserFilterModel;
+class AppChooserModel;
+class AppGridView;
+class QLineEdit;
 class QPushButton;
 class AppChooserDialog : public QDialog
 {
@@ -17,9 +20,13 @@ public:
     QStringList selectChoices();
     void updateChoices(const QStringList &choices);
     void setCurrentChoice(const QString &choice);
+    void setPreferredApps(const QStringList &appIds);
 
 private:
-    QListView *m_view;
+    QLineEdit *m_searchEdit;
+    AppGridView *m_view;
+    AppChooserModel *m_model;
+    AppChooserFilterModel *m_filterModel;
     QStringList m_choices;
 
     QPushButton *m_cancelBtn;
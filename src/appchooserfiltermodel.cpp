@@ -0,0 +1,214 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "appchooserfiltermodel.h"
+#include "appchoosermodel.h"
+
+#include <QTimer>
+
+AppChooserFilterModel::AppChooserFilterModel(QObject *parent)
+    : QAbstractProxyModel(parent)
+    , m_indexed(false)
+    , m_indexTimer(new QTimer(this))
+    , m_filtered(false)
+    , m_refilterTimer(new QTimer(this))
+{
+    // Ready before the first keystroke, without delaying the first paint
+    m_indexTimer->setSingleShot(true);
+    m_indexTimer->setInterval(0);
+    connect(m_indexTimer, &QTimer::timeout, this, &AppChooserFilterModel::ensureIndex);
+
+    // Rows change one by one, filter once they all did
+    m_refilterTimer->setSingleShot(true);
+    m_refilterTimer->setInterval(0);
+    connect(m_refilterTimer, &QTimer::timeout, this, &AppChooserFilterModel::refilterChanged);
+}
+
+void AppChooserFilterModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    beginResetModel();
+    if (auto old = this->sourceModel())
+        disconnect(old, nullptr, this, nullptr);
+    QAbstractProxyModel::setSourceModel(sourceModel);
+    if (sourceModel) {
+        // A new row list means a new index
+        auto sourceReset = [this] {
+            m_indexed = false;
+            m_indexTimer->start();
+            beginResetModel();
+            refilter();
+            endResetModel();
+        };
+        // Rows moved or inserted while filtered, the index is current already
+        auto filterReset = [this] {
+            beginResetModel();
+            refilter();
+            endResetModel();
+        };
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, sourceReset);
+        connect(sourceModel, &QAbstractItemModel::rowsMoved, this, sourceReset);
+        // Unfiltered rows map one to one, pass inserts and removals through
+        // so the view keeps its state
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeInserted, this, [this](const QModelIndex &, int first, int last) {
+            if (!m_filtered)
+                beginInsertRows(QModelIndex(), first, last);
+        });
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, [this, filterReset](const QModelIndex &, int first, int last) {
+            if (m_indexed) {
+                for (int row = first; row <= last; ++row)
+                    m_index.insert(row, entry(row));
+            } else {
+                m_indexTimer->start();
+            }
+            if (m_filtered)
+                return filterReset();
+            endInsertRows();
+        });
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &, int first, int last) {
+            if (!m_filtered)
+                beginRemoveRows(QModelIndex(), first, last);
+        });
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, [this, filterReset](const QModelIndex &, int first, int last) {
+            if (m_indexed) {
+                for (int row = last; row >= first; --row)
+                    m_index.remove(row);
+            }
+            if (m_filtered)
+                return filterReset();
+            endRemoveRows();
+        });
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &AppChooserFilterModel::onSourceDataChanged);
+    }
+    m_indexed = false;
+    m_indexTimer->start();
+    refilter();
+    endResetModel();
+}
+
+void AppChooserFilterModel::setFilterText(const QString &text)
+{
+    if (m_filterText == text)
+        return;
+    m_filterText = text;
+    beginResetModel();
+    refilter();
+    endResetModel();
+}
+
+QModelIndex AppChooserFilterModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !sourceModel())
+        return QModelIndex();
+    const int row = m_filtered ? m_proxyToSource.value(proxyIndex.row(), -1) : proxyIndex.row();
+    return row < 0 ? QModelIndex() : sourceModel()->index(row, proxyIndex.column());
+}
+
+QModelIndex AppChooserFilterModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid())
+        return QModelIndex();
+    const int row = m_filtered ? m_sourceToProxy.value(sourceIndex.row(), -1) : sourceIndex.row();
+    return row < 0 ? QModelIndex() : createIndex(row, sourceIndex.column());
+}
+
+QModelIndex AppChooserFilterModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || row < 0 || row >= rowCount() || column != 0)
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex AppChooserFilterModel::parent(const QModelIndex &child) const
+{
+    Q_UNUSED(child)
+    return QModelIndex();
+}
+
+int AppChooserFilterModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !sourceModel())
+        return 0;
+    return m_filtered ? m_proxyToSource.size() : sourceModel()->rowCount();
+}
+
+int AppChooserFilterModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 1;
+}
+
+AppSearchIndex::Entry AppChooserFilterModel::entry(int row) const
+{
+    const QModelIndex index = sourceModel()->index(row, 0);
+    return { index.data(AppChooserModel::DataRole).toString(),
+             index.data(AppChooserModel::NameRole).toString(),
+             index.data(AppChooserModel::KeywordsRole).toStringList() };
+}
+
+void AppChooserFilterModel::rebuildIndex()
+{
+    QList<AppSearchIndex::Entry> entries;
+    if (auto model = sourceModel()) {
+        const int rows = model->rowCount();
+        entries.reserve(rows);
+        for (int row = 0; row < rows; ++row)
+            entries.append(entry(row));
+    }
+    m_index.build(entries);
+    m_indexed = true;
+}
+
+void AppChooserFilterModel::ensureIndex()
+{
+    m_indexTimer->stop();
+    if (!m_indexed)
+        rebuildIndex();
+}
+
+void AppChooserFilterModel::refilter()
+{
+    m_filtered = !m_filterText.trimmed().isEmpty();
+    m_proxyToSource.clear();
+    m_sourceToProxy.clear();
+    if (!m_filtered || !sourceModel())
+        return;
+    // Only when searching started before the idle build
+    ensureIndex();
+    m_proxyToSource = m_index.search(m_filterText);
+    m_sourceToProxy.fill(-1, sourceModel()->rowCount());
+    for (int row = 0; row < m_proxyToSource.size(); ++row)
+        m_sourceToProxy[m_proxyToSource.at(row)] = row;
+}
+
+void AppChooserFilterModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    // Anything but the selection may change what matches
+    if (roles != QList<int>{ AppChooserModel::SelectRole }) {
+        if (m_indexed) {
+            for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+                m_index.update(row, entry(row));
+        }
+        if (m_filtered)
+            m_refilterTimer->start();
+    }
+
+    // Selection changes are per row, forward them row by row
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const QModelIndex index = mapFromSource(sourceModel()->index(row, 0));
+        if (index.isValid())
+            Q_EMIT dataChanged(index, index, roles);
+    }
+}
+
+void AppChooserFilterModel::refilterChanged()
+{
+    if (!m_filtered)
+        return;
+    ensureIndex();
+    // The changed rows were forwarded already, only a different result needs a reset
+    if (m_index.search(m_filterText) == m_proxyToSource)
+        return;
+    beginResetModel();
+    refilter();
+    endResetModel();
+}
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "appsearchindex.h"
+
+#include <QAbstractProxyModel>
+
+// Shows the rows of an AppChooserModel matching the search text, ranked.
+// Both directions of the row mapping are plain array lookups.
+class QTimer;
+
+class AppChooserFilterModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit AppChooserFilterModel(QObject *parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    void setFilterText(const QString &text);
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+private:
+    AppSearchIndex::Entry entry(int row) const;
+    void rebuildIndex();
+    void ensureIndex();
+    void refilter();
+    // Filters again after rows changed, resets only if the result differs
+    void refilterChanged();
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+
+    QString m_filterText;
+    AppSearchIndex m_index;
+    bool m_indexed; // the index follows the source row by row once built
+    QTimer *m_indexTimer; // builds it when idle after the source filled
+    QList<int> m_proxyToSource; // empty filter shows the source as is
+    QList<int> m_sourceToProxy; // -1 for filtered out rows
+    bool m_filtered;
+    QTimer *m_refilterTimer;
+};
@@ -3,44 +3,54 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "appchoosermodel.h"
-#include "iteminfo.h"
+#include "applicationindex.h"
 
-#include <QDBusInterface>
-#include <QDBusConnection>
-#include <QSettings>
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
+#include <climits>
 
 AppChooserModel::AppChooserModel(QObject *parent)
     :QAbstractListModel(parent)
 {
-    qDBusRegisterMetaType<ObjectInterfaceMap>();
-    qDBusRegisterMetaType<ObjectMap>();
-    qDBusRegisterMetaType<PropMap>();
-    QMetaObject::invokeMethod(this, &AppChooserModel::loadApplications, Qt::QueuedConnection);
+    // The index is shared, a new dialog shows what it knows right away
+    auto index = ApplicationIndex::instance();
+    connect(index, &ApplicationIndex::reset, this, &AppChooserModel::loadApplications);
+    connect(index, &ApplicationIndex::applicationAdded, this, &AppChooserModel::onApplicationAdded);
+    connect(index, &ApplicationIndex::applicationChanged, this, &AppChooserModel::onApplicationChanged);
+    connect(index, &ApplicationIndex::applicationRemoved, this, &AppChooserModel::onApplicationRemoved);
+    index->load();
+    loadApplications();
 }
 
 void AppChooserModel::click(const QModelIndex &index)
 {
     if (index.row() >= 0 && index.row() <= m_datas.size() -1) {
-        beginResetModel();
         m_datas[index.row()].selected = ! m_datas[index.row()].selected;
-        endResetModel();
+        const QModelIndex changed = this->index(index.row());
+        Q_EMIT dataChanged(changed, changed, { SelectRole });
     }
 }
 
 void AppChooserModel::click(const QString &appId)
 {
-    for (auto data : m_datas) {
-        if (data.appId == appId) {
-            data.selected = true;
-            break;
+    for (int row = 0; row < m_datas.size(); ++row) {
+        if (m_datas.at(row).appId == appId) {
+            m_datas[row].selected = true;
+            const QModelIndex changed = index(row);
+            Q_EMIT dataChanged(changed, changed, { SelectRole });
+            return;
         }
     }
+    // Not loaded yet, selected once it shows up
+    m_pendingSelection.append(appId);
 }
 
 QStringList AppChooserModel::choices()
 {
     QStringList list;
-    for (auto data : m_datas) {
+    for (const auto &data : std::as_const(m_datas)) {
         if (data.selected)
             list.append(data.appId);
     }
@@ -49,46 +59,222 @@ QStringList AppChooserModel::choices()
 
 void AppChooserModel::loadApplications()
 {
-    ItemInfo::registerMetaType();
-
-#ifdef QT_DEBUG
-    QDBusPendingCall call = QDBusInterface("org.desktopspec.ApplicationManager1", "/org/desktopspec/ApplicationManager1", "org.desktopspec.DBus.ObjectManager", QDBusConnection::sessionBus()).asyncCall(QString("GetManagedObjects"));
-#else
-    QDBusPendingCall call = QDBusInterface("org.desktopspec.ApplicationManager1", "/org/desktopspec/ApplicationManager1", "org.desktopspec.DBus.ObjectManager", QDBusConnection::sessionBus()).asyncCall(QString("GetManagedObjects"));
-#endif
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
-    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher* call){
-        QDBusPendingReply<ObjectMap> reply = *call;
-        if (!reply.isError()) {
-            m_datas.clear();
-            const ObjectMap objectMap = reply.value();
-            const auto language = getenv("LANGUAGE");
-            for (auto obj = objectMap.begin(); obj != objectMap.end(); obj++)
-            {
-                const ObjectInterfaceMap interfaceMap = obj.value();
-                const auto infoMap = interfaceMap.begin().value();
-                DesktopInfo info;
-                info.appId = infoMap["ID"].toString();
-                const auto nameMap = infoMap["DisplayName"].value<QDBusArgument>();
-                PropMap propName;
-                nameMap >> propName;
-                if (propName["Name"].contains(language)) {
-                    info.name = propName["Name"][language];
-                } else {
-                    info.name = propName["Name"]["default"];
-                }
-                const auto iconMap = infoMap["Icons"].value<QDBusArgument>();
-                PropMap propIcon;
-                iconMap >> propIcon;
-                info.icon = propIcon["default"]["default"];
-                info.selected = false;
-                beginInsertRows(QModelIndex(), m_datas.size(), m_datas.size());
-                m_datas.append(info);
-                endInsertRows();
-            }
-        }
-        call->deleteLater();
+    // Keep what the user already picked
+    QSet<QString> selected;
+    for (const auto &data : std::as_const(m_datas)) {
+        if (data.selected)
+            selected.insert(data.appId);
+    }
+    for (const QString &appId : std::as_const(m_pendingSelection))
+        selected.insert(appId);
+
+    auto applications = ApplicationIndex::instance()->applications();
+    if (!m_preferredApps.isEmpty()) {
+        std::stable_sort(applications.begin(), applications.end(), [this](const auto &a, const auto &b) {
+            return rank(a.appId) < rank(b.appId);
+        });
+    }
+
+    QList<DesktopInfo> datas;
+    datas.reserve(applications.size());
+    for (const auto &application : std::as_const(applications)) {
+        DesktopInfo info;
+        info.path = application.path;
+        info.appId = application.appId;
+        info.name = application.name;
+        info.icon = application.icon;
+        info.keywords = application.keywords;
+        info.selected = selected.contains(info.appId);
+        if (info.selected)
+            m_pendingSelection.removeAll(info.appId);
+        datas.append(info);
+    }
+    applyDatas(datas);
+
+    m_appIds.clear();
+    for (const auto &data : std::as_const(m_datas))
+        m_appIds.insert(data.path, data.appId);
+}
+
+void AppChooserModel::onApplicationAdded(const QString &path)
+{
+    if (m_appIds.contains(path)) {
+        onApplicationChanged(path);
+        return;
+    }
+    const auto application = ApplicationIndex::instance()->application(path);
+    if (application.path.isEmpty())
+        return;
+    const DesktopInfo info = desktopInfo(application);
+    const int row = lowerBound(rank(info.appId), info.path);
+    beginInsertRows(QModelIndex(), row, row);
+    m_datas.insert(row, info);
+    m_appIds.insert(info.path, info.appId);
+    endInsertRows();
+}
+
+void AppChooserModel::onApplicationChanged(const QString &path)
+{
+    const int row = rowOf(path);
+    if (row < 0) {
+        onApplicationAdded(path);
+        return;
+    }
+    const auto application = ApplicationIndex::instance()->application(path);
+    if (application.path.isEmpty()) {
+        onApplicationRemoved(path);
+        return;
+    }
+    DesktopInfo info = desktopInfo(application);
+    info.selected = info.selected || m_datas.at(row).selected;
+    if (rank(info.appId) != rank(m_datas.at(row).appId)) {
+        // Another place in the order, keep the choice across the move
+        if (info.selected)
+            m_pendingSelection.append(info.appId);
+        onApplicationRemoved(path);
+        onApplicationAdded(path);
+        return;
+    }
+    m_datas[row] = info;
+    m_appIds.insert(path, info.appId);
+    const QModelIndex changed = index(row);
+    Q_EMIT dataChanged(changed, changed);
+}
+
+void AppChooserModel::onApplicationRemoved(const QString &path)
+{
+    const int row = rowOf(path);
+    if (row < 0)
+        return;
+    beginRemoveRows(QModelIndex(), row, row);
+    m_datas.removeAt(row);
+    m_appIds.remove(path);
+    endRemoveRows();
+}
+
+int AppChooserModel::rank(const QString &appId) const
+{
+    const int rank = m_preferredApps.indexOf(appId);
+    return rank < 0 ? INT_MAX : rank;
+}
+
+int AppChooserModel::lowerBound(int rank, const QString &path) const
+{
+    const auto it = std::lower_bound(m_datas.cbegin(), m_datas.cend(), path, [this, rank](const DesktopInfo &info, const QString &path) {
+        const int infoRank = this->rank(info.appId);
+        return infoRank != rank ? infoRank < rank : info.path < path;
     });
+    return int(it - m_datas.cbegin());
+}
+
+int AppChooserModel::rowOf(const QString &path) const
+{
+    const auto it = m_appIds.constFind(path);
+    if (it == m_appIds.cend())
+        return -1;
+    const int row = lowerBound(rank(it.value()), path);
+    return row < m_datas.size() && m_datas.at(row).path == path ? row : -1;
+}
+
+AppChooserModel::DesktopInfo AppChooserModel::desktopInfo(const ApplicationIndex::Application &application)
+{
+    DesktopInfo info;
+    info.path = application.path;
+    info.appId = application.appId;
+    info.name = application.name;
+    info.icon = application.icon;
+    info.keywords = application.keywords;
+    // Picked before the application showed up
+    info.selected = m_pendingSelection.removeAll(info.appId) > 0;
+    return info;
+}
+
+void AppChooserModel::applyDatas(const QList<DesktopInfo> &datas)
+{
+    if (m_datas.isEmpty()) {
+        if (datas.isEmpty())
+            return;
+        beginInsertRows(QModelIndex(), 0, datas.size() - 1);
+        m_datas = datas;
+        endInsertRows();
+        return;
+    }
+
+    QSet<QString> oldPaths;
+    for (const auto &data : std::as_const(m_datas))
+        oldPaths.insert(data.path);
+    QHash<QString, int> newRows;
+    for (int row = 0; row < datas.size(); ++row)
+        newRows.insert(datas.at(row).path, row);
+
+    // Rows that stay must keep their order, otherwise it is a new list
+    QStringList oldKept;
+    for (const auto &data : std::as_const(m_datas)) {
+        if (newRows.contains(data.path))
+            oldKept.append(data.path);
+    }
+    QStringList newKept;
+    for (const auto &data : datas) {
+        if (oldPaths.contains(data.path))
+            newKept.append(data.path);
+    }
+    if (oldKept != newKept) {
+        beginResetModel();
+        m_datas = datas;
+        endResetModel();
+        return;
+    }
+
+    // Remove gone rows from the back, one signal per contiguous range
+    for (int row = m_datas.size() - 1; row >= 0;) {
+        if (newRows.contains(m_datas.at(row).path)) {
+            --row;
+            continue;
+        }
+        int first = row;
+        while (first > 0 && !newRows.contains(m_datas.at(first - 1).path))
+            --first;
+        beginRemoveRows(QModelIndex(), first, row);
+        m_datas.remove(first, row - first + 1);
+        endRemoveRows();
+        row = first - 1;
+    }
+
+    // Insert new rows front to back, the rows before each range are final
+    for (int row = 0; row < datas.size();) {
+        if (oldPaths.contains(datas.at(row).path)) {
+            ++row;
+            continue;
+        }
+        int last = row;
+        while (last + 1 < datas.size() && !oldPaths.contains(datas.at(last + 1).path))
+            ++last;
+        beginInsertRows(QModelIndex(), row, last);
+        for (int i = row; i <= last; ++i)
+            m_datas.insert(i, datas.at(i));
+        endInsertRows();
+        row = last + 1;
+    }
+
+    // Both lists line up now, only changed rows are repainted
+    for (int row = 0; row < m_datas.size(); ++row) {
+        const DesktopInfo &current = m_datas.at(row);
+        const DesktopInfo &updated = datas.at(row);
+        if (current.appId == updated.appId && current.name == updated.name && current.icon == updated.icon
+            && current.keywords == updated.keywords && current.selected == updated.selected)
+            continue;
+        m_datas[row] = updated;
+        const QModelIndex changed = index(row);
+        Q_EMIT dataChanged(changed, changed);
+    }
+}
+
+void AppChooserModel::setPreferredApps(const QStringList &appIds)
+{
+    if (m_preferredApps == appIds)
+        return;
+    m_preferredApps = appIds;
+    loadApplications();
 }
 
 int AppChooserModel::rowCount(const QModelIndex &parent) const
@@ -108,22 +294,9 @@ QVariant AppChooserModel::data(const QModelIndex &index, int role) const
         return info.name;
     case AppChooserModel::SelectRole:
         return info.selected;
+    case AppChooserModel::KeywordsRole:
+        return info.keywords;
     default:
         return QVariant();
     }
 }
-
-const QDBusArgument &operator>>(const QDBusArgument &argument, PropMap &dict) {
-    argument.beginMap();
-    while (!argument.atEnd()) {
-        QString arg;
-        QMap<QString, QString> argMap;
-        argument.beginMapEntry();
-        argument >> arg >> argMap;
-        argument.endMapEntry();
-        dict.insert(arg, argMap);
-    }
-    argument.endMap();
-    return argument;
-}
-
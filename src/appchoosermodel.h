@@ -4,29 +4,22 @@
 
 #ifndef APPCHOOSERMODEL_H
 #define APPCHOOSERMODEL_H
+#include "applicationindex.h"
+
 #include <QAbstractListModel>
+#include <QHash>
 #include <QString>
-#include <QMap>
-#include <QMetaType>
-#include <QDBusMetaType>
-#include <QDBusObjectPath>
-
-using ObjectInterfaceMap = QMap<QString, QVariantMap>;
-using ObjectMap = QMap<QDBusObjectPath, ObjectInterfaceMap>;
-using PropMap = QMap<QString, QMap<QString, QString>>;
-
-Q_DECLARE_METATYPE(ObjectMap)
-Q_DECLARE_METATYPE(ObjectInterfaceMap)
-Q_DECLARE_METATYPE(PropMap)
 
 class AppChooserModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
     struct DesktopInfo {
+      QString path;
       QString appId;
       QString name;
       QString icon;
+      QStringList keywords;
       bool selected;
     };
 
@@ -34,7 +27,8 @@ public:
         DataRole,
         NameRole,
         IconRole,
-        SelectRole
+        SelectRole,
+        KeywordsRole
     };
     explicit AppChooserModel(QObject *parent = nullptr);
 
@@ -42,9 +36,24 @@ public:
     void click(const QString &appId);
 
     QStringList choices();
+    // Listed first, in this order, e.g. the handlers of the content type
+    void setPreferredApps(const QStringList &appIds);
 
 private:
+    // Rebuilds the list, only needed when the whole index changed
     void loadApplications();
+    // Moves to datas with as few and as small change signals as possible
+    void applyDatas(const QList<DesktopInfo> &datas);
+
+    void onApplicationAdded(const QString &path);
+    void onApplicationChanged(const QString &path);
+    void onApplicationRemoved(const QString &path);
+
+    // Rows are ordered by rank, then by object path like the index
+    int rank(const QString &appId) const;
+    int lowerBound(int rank, const QString &path) const;
+    int rowOf(const QString &path) const;
+    DesktopInfo desktopInfo(const ApplicationIndex::Application &application);
 
 protected:
     int rowCount(const QModelIndex &parent) const override;
@@ -52,6 +61,9 @@ protected:
 
 private:
     QList<DesktopInfo> m_datas;
+    QHash<QString, QString> m_appIds; // path -> appId of every row
+    QStringList m_preferredApps;
+    QStringList m_pendingSelection;
 };
 
 #endif // APPCHOOSERMODEL_H
@@ -0,0 +1,272 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "appgridview.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+
+AppGridView::AppGridView(QWidget *parent)
+    : QAbstractItemView(parent)
+{
+    setVerticalScrollMode(ScrollPerPixel);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+}
+
+QRect AppGridView::visualRect(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.parent() != rootIndex())
+        return QRect();
+    return cellRect(index.row()).translated(-horizontalOffset(), -verticalOffset());
+}
+
+void AppGridView::scrollTo(const QModelIndex &index, ScrollHint hint)
+{
+    if (!index.isValid())
+        return;
+    const QRect rect = cellRect(index.row());
+    const int height = viewport()->height();
+    const int top = verticalOffset();
+    int value = top;
+    switch (hint) {
+    case PositionAtTop:
+        value = rect.top();
+        break;
+    case PositionAtBottom:
+        value = rect.bottom() + 1 - height;
+        break;
+    case PositionAtCenter:
+        value = rect.center().y() - height / 2;
+        break;
+    case EnsureVisible:
+        if (rect.top() < top)
+            value = rect.top();
+        else if (rect.bottom() + 1 > top + height)
+            value = rect.bottom() + 1 - height;
+        break;
+    }
+    verticalScrollBar()->setValue(value);
+}
+
+QModelIndex AppGridView::indexAt(const QPoint &point) const
+{
+    const QSize cell = cellSize();
+    if (cell.isEmpty())
+        return QModelIndex();
+    const QPoint position = point + QPoint(horizontalOffset(), verticalOffset());
+    if (position.x() < 0 || position.y() < 0)
+        return QModelIndex();
+    const int column = position.x() / cell.width();
+    if (column >= columnCount())
+        return QModelIndex();
+    const int row = position.y() / cell.height() * columnCount() + column;
+    return row < itemCount() ? model()->index(row, 0, rootIndex()) : QModelIndex();
+}
+
+void AppGridView::setModel(QAbstractItemModel *model)
+{
+    if (this->model())
+        disconnect(this->model(), &QAbstractItemModel::rowsRemoved, this, &AppGridView::relayout);
+    m_cellSize = QSize();
+    QAbstractItemView::setModel(model);
+    if (model)
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &AppGridView::relayout);
+}
+
+void AppGridView::reset()
+{
+    m_cellSize = QSize();
+    QAbstractItemView::reset();
+}
+
+void AppGridView::rowsInserted(const QModelIndex &parent, int start, int end)
+{
+    QAbstractItemView::rowsInserted(parent, start, end);
+    if (parent == rootIndex())
+        relayout();
+}
+
+void AppGridView::relayout()
+{
+    updateGeometries();
+    viewport()->update();
+}
+
+QModelIndex AppGridView::moveCursor(CursorAction cursorAction, Qt::KeyboardModifiers modifiers)
+{
+    Q_UNUSED(modifiers)
+    const int count = itemCount();
+    if (count == 0)
+        return QModelIndex();
+    const QModelIndex current = currentIndex();
+    if (!current.isValid())
+        return model()->index(0, 0, rootIndex());
+
+    const int columns = columnCount();
+    const int pageRows = qMax(1, viewport()->height() / qMax(1, cellSize().height()));
+    int row = current.row();
+    switch (cursorAction) {
+    case MoveLeft:
+    case MovePrevious:
+        --row;
+        break;
+    case MoveRight:
+    case MoveNext:
+        ++row;
+        break;
+    case MoveUp:
+        row -= columns;
+        break;
+    case MoveDown:
+        row += columns;
+        break;
+    case MovePageUp:
+        row -= columns * pageRows;
+        break;
+    case MovePageDown:
+        row += columns * pageRows;
+        break;
+    case MoveHome:
+        row = 0;
+        break;
+    case MoveEnd:
+        row = count - 1;
+        break;
+    }
+    return model()->index(qBound(0, row, count - 1), 0, rootIndex());
+}
+
+int AppGridView::horizontalOffset() const
+{
+    return horizontalScrollBar()->value();
+}
+
+int AppGridView::verticalOffset() const
+{
+    return verticalScrollBar()->value();
+}
+
+bool AppGridView::isIndexHidden(const QModelIndex &index) const
+{
+    Q_UNUSED(index)
+    return false;
+}
+
+void AppGridView::setSelection(const QRect &rect, QItemSelectionModel::SelectionFlags command)
+{
+    const QSize cell = cellSize();
+    const int count = itemCount();
+    if (cell.isEmpty() || count == 0)
+        return;
+    const QRect area = rect.normalized().translated(horizontalOffset(), verticalOffset());
+    const int columns = columnCount();
+    const int firstColumn = qBound(0, area.left() / cell.width(), columns - 1);
+    const int lastColumn = qBound(0, area.right() / cell.width(), columns - 1);
+    const int firstRow = qMax(0, area.top() / cell.height());
+    const int lastRow = qMin((count - 1) / columns, area.bottom() / cell.height());
+
+    // One range per grid row, the covered cells of a row are adjacent rows of the model
+    QItemSelection selection;
+    for (int gridRow = firstRow; gridRow <= lastRow; ++gridRow) {
+        const int first = gridRow * columns + firstColumn;
+        const int last = qMin(count - 1, gridRow * columns + lastColumn);
+        if (first <= last)
+            selection.select(model()->index(first, 0, rootIndex()), model()->index(last, 0, rootIndex()));
+    }
+    selectionModel()->select(selection, command);
+}
+
+QRegion AppGridView::visualRegionForSelection(const QItemSelection &selection) const
+{
+    const QSize cell = cellSize();
+    if (cell.isEmpty())
+        return QRegion();
+    // Only what can be seen needs repainting, however large the selection
+    const int columns = columnCount();
+    const int firstVisible = verticalOffset() / cell.height() * columns;
+    const int lastVisible = (verticalOffset() + viewport()->height()) / cell.height() * columns + columns - 1;
+    QRegion region;
+    for (const QItemSelectionRange &range : selection) {
+        if (range.parent() != rootIndex())
+            continue;
+        const int first = qMax(range.top(), firstVisible);
+        const int last = qMin(range.bottom(), lastVisible);
+        for (int row = first; row <= last; ++row)
+            region += cellRect(row).translated(-horizontalOffset(), -verticalOffset());
+    }
+    return region;
+}
+
+void AppGridView::updateGeometries()
+{
+    const QSize cell = cellSize();
+    const int columns = columnCount();
+    const int rows = cell.isEmpty() ? 0 : (itemCount() + columns - 1) / columns;
+    const int height = viewport()->height();
+    verticalScrollBar()->setSingleStep(qMax(1, cell.height()));
+    verticalScrollBar()->setPageStep(height);
+    verticalScrollBar()->setRange(0, qMax(0, rows * cell.height() - height));
+    horizontalScrollBar()->setRange(0, 0);
+    QAbstractItemView::updateGeometries();
+}
+
+void AppGridView::paintEvent(QPaintEvent *event)
+{
+    const QSize cell = cellSize();
+    const int count = itemCount();
+    if (cell.isEmpty() || count == 0)
+        return;
+
+    QPainter painter(viewport());
+    QStyleOptionViewItem option;
+    initViewItemOption(&option);
+
+    const int columns = columnCount();
+    const QRect area = event->rect().translated(horizontalOffset(), verticalOffset());
+    const int firstRow = qMax(0, area.top() / cell.height()) * columns;
+    const int lastRow = qMin(count - 1, (area.bottom() / cell.height() + 1) * columns - 1);
+    const QModelIndex current = currentIndex();
+    for (int row = firstRow; row <= lastRow; ++row) {
+        const QModelIndex index = model()->index(row, 0, rootIndex());
+        option.rect = visualRect(index);
+        option.state = isEnabled() ? QStyle::State_Enabled : QStyle::State_None;
+        if (selectionModel() && selectionModel()->isSelected(index))
+            option.state |= QStyle::State_Selected;
+        if (index == current && hasFocus())
+            option.state |= QStyle::State_HasFocus;
+        option.features.setFlag(QStyleOptionViewItem::Alternate, alternatingRowColors() && (row % 2));
+        style()->drawPrimitive(QStyle::PE_PanelItemViewRow, &option, &painter, this);
+        itemDelegateForIndex(index)->paint(&painter, option, index);
+    }
+}
+
+QSize AppGridView::cellSize() const
+{
+    if (!m_cellSize.isValid() && itemCount() > 0) {
+        QStyleOptionViewItem option;
+        initViewItemOption(&option);
+        const QModelIndex first = model()->index(0, 0, rootIndex());
+        m_cellSize = itemDelegateForIndex(first)->sizeHint(option, first);
+    }
+    return m_cellSize.isValid() ? m_cellSize : QSize();
+}
+
+int AppGridView::columnCount() const
+{
+    const int width = cellSize().width();
+    return width > 0 ? qMax(1, viewport()->width() / width) : 1;
+}
+
+int AppGridView::itemCount() const
+{
+    return model() ? model()->rowCount(rootIndex()) : 0;
+}
+
+QRect AppGridView::cellRect(int row) const
+{
+    const QSize cell = cellSize();
+    const int columns = columnCount();
+    return QRect(QPoint(row % columns * cell.width(), row / columns * cell.height()), cell);
+}
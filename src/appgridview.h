@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QAbstractItemView>
+
+// Lays a flat model out left to right in equally sized cells, wrapping at
+// the viewport width. Every position is computed from the row number, so
+// resizing and scrolling cost the same no matter how many rows there are,
+// and painting only touches the visible cells. The cell size is the size
+// hint of the first row.
+class AppGridView : public QAbstractItemView
+{
+    Q_OBJECT
+
+public:
+    explicit AppGridView(QWidget *parent = nullptr);
+
+    QRect visualRect(const QModelIndex &index) const override;
+    void scrollTo(const QModelIndex &index, ScrollHint hint = EnsureVisible) override;
+    QModelIndex indexAt(const QPoint &point) const override;
+
+    void setModel(QAbstractItemModel *model) override;
+    void reset() override;
+
+protected Q_SLOTS:
+    void rowsInserted(const QModelIndex &parent, int start, int end) override;
+
+protected:
+    QModelIndex moveCursor(CursorAction cursorAction, Qt::KeyboardModifiers modifiers) override;
+    int horizontalOffset() const override;
+    int verticalOffset() const override;
+    bool isIndexHidden(const QModelIndex &index) const override;
+    void setSelection(const QRect &rect, QItemSelectionModel::SelectionFlags command) override;
+    QRegion visualRegionForSelection(const QItemSelection &selection) const override;
+    void updateGeometries() override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    // The base view neither lays out nor repaints for inserted or removed rows
+    void relayout();
+
+    QSize cellSize() const;
+    int columnCount() const;
+    int itemCount() const;
+    // In content coordinates, i.e. not scrolled
+    QRect cellRect(int row) const;
+
+    mutable QSize m_cellSize; // invalid until asked for with a non empty model
+};
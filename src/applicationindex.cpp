@@ -0,0 +1,280 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "applicationindex.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+
+Q_LOGGING_CATEGORY(XdgDesktopDDEAppIndex, "xdg-dde-app-index")
+
+static const QString ApplicationManagerService = QStringLiteral("org.desktopspec.ApplicationManager1");
+static const QString ApplicationManagerPath = QStringLiteral("/org/desktopspec/ApplicationManager1");
+static const QString ObjectManagerInterface = QStringLiteral("org.desktopspec.DBus.ObjectManager");
+static const QString ApplicationInterface = QStringLiteral("org.desktopspec.ApplicationManager1.Application");
+
+// Bump whenever Application or the record layout changes
+static constexpr quint32 SnapshotMagic = 0x41505049; // "APPI"
+static constexpr quint32 SnapshotVersion = 3;
+static constexpr int SnapshotDelay = 5000;
+
+static QDataStream &operator<<(QDataStream &stream, const ApplicationIndex::Application &application)
+{
+    return stream << application.path << application.appId << application.name << application.icon << application.mimeTypes << application.keywords;
+}
+
+static QDataStream &operator>>(QDataStream &stream, ApplicationIndex::Application &application)
+{
+    return stream >> application.path >> application.appId >> application.name >> application.icon >> application.mimeTypes >> application.keywords;
+}
+
+// Names are localized, a snapshot taken in another language is stale
+static QString snapshotLanguage()
+{
+    return QString::fromLocal8Bit(qgetenv("LANGUAGE"));
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, PropMap &dict)
+{
+    argument.beginMap();
+    while (!argument.atEnd()) {
+        QString arg;
+        QMap<QString, QString> argMap;
+        argument.beginMapEntry();
+        argument >> arg >> argMap;
+        argument.endMapEntry();
+        dict.insert(arg, argMap);
+    }
+    argument.endMap();
+    return argument;
+}
+
+ApplicationIndex *ApplicationIndex::instance()
+{
+    static ApplicationIndex *index = new ApplicationIndex(qApp);
+    return index;
+}
+
+ApplicationIndex::ApplicationIndex(QObject *parent)
+    : QObject(parent)
+    , m_loadRequested(false)
+    , m_loading(false)
+    , m_loaded(false)
+    , m_enumerateAgain(false)
+    , m_snapshotFile(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                     + QStringLiteral("/xdg-desktop-portal-dde/applications"))
+    , m_snapshotTimer(new QTimer(this))
+{
+    m_snapshotTimer->setSingleShot(true);
+    m_snapshotTimer->setInterval(SnapshotDelay);
+    connect(m_snapshotTimer, &QTimer::timeout, this, &ApplicationIndex::writeSnapshot);
+    m_writer.setMaxThreadCount(1);
+
+    qDBusRegisterMetaType<ObjectInterfaceMap>();
+    qDBusRegisterMetaType<ObjectMap>();
+    qDBusRegisterMetaType<PropMap>();
+
+    // Subscribe before enumerating so no change falls in between
+    auto bus = QDBusConnection::sessionBus();
+    bus.connect(ApplicationManagerService, ApplicationManagerPath, ObjectManagerInterface, QStringLiteral("InterfacesAdded"),
+                this, SLOT(onInterfacesAdded(QDBusObjectPath, ObjectInterfaceMap)));
+    bus.connect(ApplicationManagerService, ApplicationManagerPath, ObjectManagerInterface, QStringLiteral("InterfacesRemoved"),
+                this, SLOT(onInterfacesRemoved(QDBusObjectPath, QStringList)));
+
+    // The manager may start after us or restart, enumerate whenever it shows up
+    auto serviceWatcher = new QDBusServiceWatcher(ApplicationManagerService, bus, QDBusServiceWatcher::WatchForRegistration, this);
+    connect(serviceWatcher, &QDBusServiceWatcher::serviceRegistered, this, [this] {
+        if (!m_loadRequested)
+            return;
+        qCDebug(XdgDesktopDDEAppIndex) << ApplicationManagerService << "registered, enumerating again";
+        enumerate();
+    });
+}
+
+void ApplicationIndex::load()
+{
+    if (m_loadRequested)
+        return;
+    m_loadRequested = true;
+
+    // Serve the snapshot until the real answer is there, it is replaced then
+    if (readSnapshot()) {
+        m_loaded = true;
+        qCDebug(XdgDesktopDDEAppIndex) << "loaded" << m_applications.size() << "applications from" << m_snapshotFile;
+        Q_EMIT reset();
+    }
+    enumerate();
+}
+
+void ApplicationIndex::enumerate()
+{
+    if (m_loading) {
+        // The running call may have gone to the old or a missing service
+        m_enumerateAgain = true;
+        return;
+    }
+    m_loading = true;
+    m_enumerateAgain = false;
+
+    auto message = QDBusMessage::createMethodCall(ApplicationManagerService, ApplicationManagerPath, ObjectManagerInterface, QStringLiteral("GetManagedObjects"));
+    auto watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+        QDBusPendingReply<ObjectMap> reply = *call;
+        m_loading = false;
+        if (m_enumerateAgain) {
+            enumerate();
+            return;
+        }
+        if (reply.isError()) {
+            // Retried once the service registers
+            qCWarning(XdgDesktopDDEAppIndex) << "Failed to enumerate applications:" << reply.error().message();
+            return;
+        }
+
+        QMap<QString, Application> applications;
+        const ObjectMap objectMap = reply.value();
+        for (auto obj = objectMap.cbegin(); obj != objectMap.cend(); ++obj) {
+            Application application;
+            if (parseApplication(obj.key(), obj.value(), application))
+                applications.insert(application.path, application);
+        }
+        m_loaded = true;
+        qCDebug(XdgDesktopDDEAppIndex) << "indexed" << applications.size() << "applications";
+        if (applications == m_applications) {
+            // The snapshot was right, nothing to tell anyone
+            return;
+        }
+        m_applications = applications;
+        scheduleSnapshot();
+        Q_EMIT reset();
+    });
+}
+
+void ApplicationIndex::onInterfacesAdded(const QDBusObjectPath &path, const ObjectInterfaceMap &interfaces)
+{
+    Application application;
+    if (!parseApplication(path, interfaces, application))
+        return;
+    const bool known = m_applications.contains(application.path);
+    m_applications.insert(application.path, application);
+    scheduleSnapshot();
+    if (known)
+        Q_EMIT applicationChanged(application.path);
+    else
+        Q_EMIT applicationAdded(application.path);
+}
+
+void ApplicationIndex::onInterfacesRemoved(const QDBusObjectPath &path, const QStringList &interfaces)
+{
+    if (!interfaces.contains(ApplicationInterface) || !m_applications.remove(path.path()))
+        return;
+    scheduleSnapshot();
+    Q_EMIT applicationRemoved(path.path());
+}
+
+bool ApplicationIndex::parseApplication(const QDBusObjectPath &path, const ObjectInterfaceMap &interfaces, Application &application)
+{
+    auto it = interfaces.constFind(ApplicationInterface);
+    if (it == interfaces.cend())
+        return false;
+    const QVariantMap &infoMap = it.value();
+
+    application.path = path.path();
+    application.appId = infoMap.value(QStringLiteral("ID")).toString();
+
+    const auto language = getenv("LANGUAGE");
+    PropMap propName;
+    infoMap.value(QStringLiteral("DisplayName")).value<QDBusArgument>() >> propName;
+    if (propName["Name"].contains(language)) {
+        application.name = propName["Name"][language];
+    } else {
+        application.name = propName["Name"]["default"];
+    }
+
+    PropMap propIcon;
+    infoMap.value(QStringLiteral("Icons")).value<QDBusArgument>() >> propIcon;
+    application.icon = propIcon["default"]["default"];
+    application.mimeTypes = infoMap.value(QStringLiteral("MimeTypes")).toStringList();
+
+    // Localized like the name when it comes as a map
+    const QVariant keywords = infoMap.value(QStringLiteral("Keywords"));
+    if (keywords.metaType() == QMetaType::fromType<QDBusArgument>()) {
+        QMap<QString, QStringList> localized;
+        keywords.value<QDBusArgument>() >> localized;
+        application.keywords = localized.contains(language) ? localized.value(language) : localized.value(QStringLiteral("default"));
+    } else {
+        application.keywords = keywords.toStringList();
+    }
+    return !application.appId.isEmpty();
+}
+
+bool ApplicationIndex::readSnapshot()
+{
+    QFile file(m_snapshotFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    // Every record is decoded anyway, a plain sequential read is all it takes
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString language;
+    quint32 count = 0;
+    stream >> magic >> version >> language >> count;
+    if (magic != SnapshotMagic || version != SnapshotVersion || language != snapshotLanguage())
+        return false;
+
+    QMap<QString, Application> applications;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        Application application;
+        stream >> application;
+        applications.insert(application.path, application);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(XdgDesktopDDEAppIndex) << "Ignoring truncated snapshot" << m_snapshotFile;
+        return false;
+    }
+    m_applications = applications;
+    return true;
+}
+
+void ApplicationIndex::scheduleSnapshot()
+{
+    if (!m_snapshotTimer->isActive())
+        m_snapshotTimer->start();
+}
+
+void ApplicationIndex::writeSnapshot()
+{
+    // Written from a snapshot of the index on the writer thread
+    m_writer.start([fileName = m_snapshotFile, applications = m_applications, language = snapshotLanguage()] {
+        QDir().mkpath(QFileInfo(fileName).absolutePath());
+        QSaveFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCWarning(XdgDesktopDDEAppIndex) << "Failed to open" << fileName << file.errorString();
+            return;
+        }
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << SnapshotMagic << SnapshotVersion << language << quint32(applications.size());
+        for (const Application &application : applications)
+            stream << application;
+        if (!file.commit())
+            qCWarning(XdgDesktopDDEAppIndex) << "Failed to write" << fileName << file.errorString();
+    });
+}
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QDBusObjectPath>
+#include <QMap>
+#include <QObject>
+#include <QThreadPool>
+#include <QVariantMap>
+
+class QTimer;
+
+using ObjectInterfaceMap = QMap<QString, QVariantMap>;
+using ObjectMap = QMap<QDBusObjectPath, ObjectInterfaceMap>;
+using PropMap = QMap<QString, QMap<QString, QString>>;
+
+Q_DECLARE_METATYPE(ObjectMap)
+Q_DECLARE_METATYPE(ObjectInterfaceMap)
+Q_DECLARE_METATYPE(PropMap)
+
+// The applications known to ApplicationManager1, shared by every app
+// chooser. Enumerated once in the background, then kept current through
+// the ObjectManager signals instead of enumerating again. A snapshot in
+// the cache directory makes it usable before ApplicationManager1 replied.
+class ApplicationIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Application
+    {
+        QString path; // object path on ApplicationManager1
+        QString appId;
+        QString name;
+        QString icon;
+        QStringList mimeTypes; // MimeType key of the desktop entry
+        QStringList keywords; // localized Keywords key
+
+        inline bool operator==(const Application &other) const
+        {
+            return path == other.path && appId == other.appId && name == other.name && icon == other.icon
+                    && mimeTypes == other.mimeTypes && keywords == other.keywords;
+        }
+    };
+
+    static ApplicationIndex *instance();
+
+    // Reads the snapshot and starts the enumeration, which runs again
+    // whenever the application manager (re)appears on the bus
+    void load();
+    inline bool isLoaded() const { return m_loaded; }
+
+    // Ordered by object path, the order stays stable across updates
+    inline QList<Application> applications() const { return m_applications.values(); }
+    inline int count() const { return m_applications.size(); }
+    // An empty Application if path is not known
+    inline Application application(const QString &path) const { return m_applications.value(path); }
+
+Q_SIGNALS:
+    // The whole index was replaced, e.g. after the enumeration finished
+    void reset();
+    void applicationAdded(const QString &path);
+    void applicationChanged(const QString &path);
+    void applicationRemoved(const QString &path);
+
+private Q_SLOTS:
+    void onInterfacesAdded(const QDBusObjectPath &path, const ObjectInterfaceMap &interfaces);
+    void onInterfacesRemoved(const QDBusObjectPath &path, const QStringList &interfaces);
+
+private:
+    explicit ApplicationIndex(QObject *parent = nullptr);
+
+    static bool parseApplication(const QDBusObjectPath &path, const ObjectInterfaceMap &interfaces, Application &application);
+
+    void enumerate();
+    bool readSnapshot();
+    void scheduleSnapshot();
+    void writeSnapshot();
+
+    bool m_loadRequested;
+    bool m_loading;
+    bool m_loaded;
+    bool m_enumerateAgain;
+    QMap<QString, Application> m_applications;
+    QString m_snapshotFile;
+    QTimer *m_snapshotTimer;
+    QThreadPool m_writer;
+};
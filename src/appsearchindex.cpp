@@ -0,0 +1,247 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "appsearchindex.h"
+
+#include <QRegularExpression>
+#include <QSet>
+#include <QSettings>
+
+#include <algorithm>
+
+// Longest indexed substring, longer queries intersect these
+static constexpr int GramSize = 3;
+
+static const QString UsageGroup = QStringLiteral("AppChooserUsage");
+
+static QSettings &usageSettings()
+{
+    static QSettings settings(QStringLiteral("deepin"), QStringLiteral("xdg-desktop-portal-dde"));
+    return settings;
+}
+
+static QStringList splitWords(const QString &text)
+{
+    // Ids split on their dots and dashes too, "org.gnome.gedit" finds "gedit"
+    static const QRegularExpression separators(QStringLiteral("[\\s._\\-/]+"));
+    return text.toLower().split(separators, Qt::SkipEmptyParts);
+}
+
+// Every substring of every word, CJK names have no spaces to split words on
+static QSet<QString> gramsOf(const QStringList &words)
+{
+    QSet<QString> grams;
+    for (const QString &word : words) {
+        for (int length = 1; length <= GramSize; ++length) {
+            for (int i = 0; i + length <= word.size(); ++i)
+                grams.insert(word.mid(i, length));
+        }
+    }
+    return grams;
+}
+
+AppSearchIndex::Document AppSearchIndex::makeDocument(const Entry &entry, QSettings &settings)
+{
+    Document document;
+    document.appId = entry.appId.toLower();
+    document.name = entry.name.toLower();
+    document.words = splitWords(entry.name) + splitWords(entry.appId);
+    for (const QString &keyword : entry.keywords)
+        document.words += splitWords(keyword);
+    document.words.removeDuplicates();
+    document.usage = settings.value(entry.appId, 0).toInt();
+    return document;
+}
+
+void AppSearchIndex::build(const QList<Entry> &entries)
+{
+    m_documents.clear();
+    m_freeIds.clear();
+    m_rows.clear();
+    m_grams.clear();
+    m_documents.reserve(entries.size());
+    m_rows.reserve(entries.size());
+
+    auto &settings = usageSettings();
+    settings.beginGroup(UsageGroup);
+    for (int row = 0; row < entries.size(); ++row) {
+        Document document = makeDocument(entries.at(row), settings);
+        document.row = row;
+        m_rows.append(addDocument(document));
+    }
+    settings.endGroup();
+}
+
+void AppSearchIndex::insert(int row, const Entry &entry)
+{
+    auto &settings = usageSettings();
+    settings.beginGroup(UsageGroup);
+    const Document document = makeDocument(entry, settings);
+    settings.endGroup();
+    m_rows.insert(row, addDocument(document));
+    renumber(row);
+}
+
+void AppSearchIndex::remove(int row)
+{
+    const int id = m_rows.takeAt(row);
+    removePostings(id);
+    m_documents[id] = Document();
+    m_freeIds.append(id);
+    renumber(row);
+}
+
+void AppSearchIndex::update(int row, const Entry &entry)
+{
+    const int id = m_rows.at(row);
+    removePostings(id);
+    auto &settings = usageSettings();
+    settings.beginGroup(UsageGroup);
+    m_documents[id] = makeDocument(entry, settings);
+    settings.endGroup();
+    m_documents[id].row = row;
+    addPostings(id);
+}
+
+int AppSearchIndex::addDocument(const Document &document)
+{
+    int id;
+    if (m_freeIds.isEmpty()) {
+        id = m_documents.size();
+        m_documents.append(document);
+    } else {
+        id = m_freeIds.takeLast();
+        m_documents[id] = document;
+    }
+    addPostings(id);
+    return id;
+}
+
+void AppSearchIndex::addPostings(int id)
+{
+    for (const QString &gram : gramsOf(m_documents.at(id).words)) {
+        QList<int> &ids = m_grams[gram];
+        // Appending while building, reused ids go to their sorted place
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it == ids.end() || *it != id)
+            ids.insert(it, id);
+    }
+}
+
+void AppSearchIndex::removePostings(int id)
+{
+    for (const QString &gram : gramsOf(m_documents.at(id).words)) {
+        auto posting = m_grams.find(gram);
+        if (posting == m_grams.end())
+            continue;
+        QList<int> &ids = posting.value();
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it != ids.end() && *it == id)
+            ids.erase(it);
+        if (ids.isEmpty())
+            m_grams.erase(posting);
+    }
+}
+
+void AppSearchIndex::renumber(int firstRow)
+{
+    for (int row = firstRow; row < m_rows.size(); ++row)
+        m_documents[m_rows.at(row)].row = row;
+}
+
+QList<int> AppSearchIndex::search(const QString &query) const
+{
+    const QString needle = query.trimmed().toLower();
+    QList<int> ids;
+    if (needle.isEmpty())
+        return ids;
+
+    // Candidates share every gram of the longest word of the query
+    const QStringList words = splitWords(needle);
+    QString key = words.isEmpty() ? needle : words.first();
+    for (const QString &word : words) {
+        if (word.size() > key.size())
+            key = word;
+    }
+    if (key.size() <= GramSize) {
+        ids = m_grams.value(key);
+    } else {
+        QList<const QList<int> *> postings;
+        for (int i = 0; i + GramSize <= key.size(); ++i) {
+            auto it = m_grams.constFind(key.mid(i, GramSize));
+            if (it == m_grams.cend())
+                return QList<int>();
+            postings.append(&it.value());
+        }
+        std::sort(postings.begin(), postings.end(), [](const QList<int> *a, const QList<int> *b) {
+            return a->size() < b->size();
+        });
+        ids = *postings.first();
+        for (int i = 1; i < postings.size() && !ids.isEmpty(); ++i) {
+            QList<int> intersection;
+            std::set_intersection(ids.cbegin(), ids.cend(), postings.at(i)->cbegin(), postings.at(i)->cend(), std::back_inserter(intersection));
+            ids = intersection;
+        }
+    }
+
+    // Postings hold document ids, ties keep the row order
+    QList<QPair<int, const Document *>> scored;
+    scored.reserve(ids.size());
+    for (int id : std::as_const(ids)) {
+        const Document &document = m_documents.at(id);
+        const int value = score(document, needle, words);
+        if (value > 0)
+            scored.append({ value, &document });
+    }
+    std::sort(scored.begin(), scored.end(), [](const QPair<int, const Document *> &a, const QPair<int, const Document *> &b) {
+        if (a.first != b.first)
+            return a.first > b.first;
+        if (a.second->usage != b.second->usage)
+            return a.second->usage > b.second->usage;
+        return a.second->row < b.second->row;
+    });
+
+    QList<int> rows;
+    rows.reserve(scored.size());
+    for (const auto &entry : std::as_const(scored))
+        rows.append(entry.second->row);
+    return rows;
+}
+
+int AppSearchIndex::score(const Document &document, const QString &query, const QStringList &words) const
+{
+    if (document.name == query || document.appId == query)
+        return 100;
+    if (document.name.startsWith(query))
+        return 80;
+    // Every word of the query starts a word of the app, "te ed" finds "Text Editor"
+    bool allWords = true;
+    for (const QString &word : words) {
+        allWords = std::any_of(document.words.cbegin(), document.words.cend(), [&word](const QString &candidate) {
+            return candidate.startsWith(word);
+        });
+        if (!allWords)
+            break;
+    }
+    if (allWords)
+        return 60;
+    if (document.name.contains(query))
+        return 40;
+    if (document.appId.contains(query))
+        return 20;
+    for (const QString &word : document.words) {
+        if (word.contains(query))
+            return 10;
+    }
+    return 0;
+}
+
+void AppSearchIndex::recordUsage(const QStringList &appIds)
+{
+    auto &settings = usageSettings();
+    settings.beginGroup(UsageGroup);
+    for (const QString &appId : appIds)
+        settings.setValue(appId, settings.value(appId, 0).toInt() + 1);
+    settings.endGroup();
+}
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QStringList>
+
+class QSettings;
+
+// Search over the app chooser rows. Names, ids and keywords are split into
+// lowercase words once, and every substring of up to three characters is
+// indexed. A query then only looks at the rows sharing its trigrams, or
+// containing it when it is shorter than a trigram. Rows can be inserted,
+// removed and updated one by one, postings refer to stable document ids so
+// the other rows keep theirs.
+class AppSearchIndex
+{
+public:
+    struct Entry
+    {
+        QString appId;
+        QString name;
+        QStringList keywords;
+    };
+
+    void build(const QList<Entry> &entries);
+    void insert(int row, const Entry &entry);
+    void remove(int row);
+    void update(int row, const Entry &entry);
+    inline bool isEmpty() const { return m_rows.isEmpty(); }
+    inline int count() const { return m_rows.size(); }
+
+    // Matching rows, best first: match quality, then how often the app was chosen
+    QList<int> search(const QString &query) const;
+
+    // Counts the apps the user picked, search ranks them higher afterwards
+    static void recordUsage(const QStringList &appIds);
+
+private:
+    struct Document
+    {
+        QString appId; // lowercase
+        QString name;  // lowercase
+        QStringList words; // of name, id and keywords
+        int usage = 0;
+        int row = -1;
+    };
+
+    static Document makeDocument(const Entry &entry, QSettings &settings);
+    int score(const Document &document, const QString &query, const QStringList &words) const;
+    int addDocument(const Document &document);
+    void addPostings(int id);
+    void removePostings(int id);
+    void renumber(int firstRow);
+
+    QList<Document> m_documents; // by id, ids of removed rows are reused
+    QList<int> m_freeIds;
+    QList<int> m_rows; // row -> document id
+    QHash<QString, QList<int>> m_grams; // of one to three characters -> sorted ids
+};
@@ -5,10 +5,19 @@
 #pragma once
 
 #include <QDBusArgument>
+#include <QDBusContext>
 #include <QMap>
+#include <QObject>
 #include <QString>
 
 /// a{sa{sv}}
 using VariantMapMap = QMap<QString, QMap<QString, QVariant>>;
 
 Q_DECLARE_METATYPE(VariantMapMap)
+
+// Adaptors are no QDBusContext themselves, the object they are attached to is
+inline QDBusContext *dbusContext(QObject *adaptor)
+{
+    QObject *parent = adaptor ? adaptor->parent() : nullptr;
+    return parent ? reinterpret_cast<QDBusContext *>(parent->qt_metacast("QDBusContext")) : nullptr;
+}
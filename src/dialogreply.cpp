@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dialogreply.h"
+#include "dbushelpers.h"
+#include "request.h"
+
+#include <QDBusAbstractAdaptor>
+#include <QDBusConnection>
+#include <QDialog>
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(XdgDesktopDDEDialog, "xdg-dde-dialog")
+
+DialogReply::DialogReply(QDialog *dialog, const QDBusMessage &message, const ResultHandler &handler)
+    : QObject(dialog)
+    , m_dialog(dialog)
+    , m_message(message)
+    , m_handler(handler)
+    , m_replied(false)
+{
+    connect(dialog, &QDialog::finished, this, &DialogReply::onFinished);
+}
+
+DialogReply::~DialogReply()
+{
+    // Destroyed before it finished, e.g. on shutdown, the caller still gets an answer
+    sendReply(2, QVariantMap());
+}
+
+DialogReply *DialogReply::show(QDBusAbstractAdaptor *portal,
+                               const QDBusObjectPath &handle,
+                               QDialog *dialog,
+                               bool modal,
+                               const ResultHandler &handler)
+{
+    // Direct calls, e.g. for debugging, have no message to answer
+    QDBusMessage message;
+    auto context = dbusContext(portal);
+    if (context && context->calledFromDBus()) {
+        context->setDelayedReply(true);
+        message = context->message();
+    }
+
+    auto reply = new DialogReply(dialog, message, handler);
+    reply->m_request = new Request(handle, QVariant(), dialog);
+    connect(reply->m_request, &Request::closeRequested, dialog, &QDialog::reject);
+
+    // Never application modal, that would block the dialogs of other apps.
+    // The transient parent set by the caller limits it to the app window.
+    dialog->setWindowModality(modal ? Qt::WindowModal : Qt::NonModal);
+    dialog->show();
+    return reply;
+}
+
+void DialogReply::onFinished(int result)
+{
+    QVariantMap results;
+    const uint response = m_handler ? m_handler(result, results) : (result == QDialog::Accepted ? 0 : 1);
+    sendReply(response, results);
+
+    // The dialog may outlive this call when it is reused, nothing of the
+    // call must stay attached to it
+    disconnect(m_dialog, nullptr, this, nullptr);
+    if (m_request) {
+        disconnect(m_request, nullptr, m_dialog, nullptr);
+        m_request->deleteLater();
+    }
+    deleteLater();
+    if (m_disposer)
+        m_disposer(m_dialog);
+    else
+        m_dialog->deleteLater();
+}
+
+void DialogReply::sendReply(uint response, const QVariantMap &results)
+{
+    if (m_replied)
+        return;
+    m_replied = true;
+    if (m_message.type() != QDBusMessage::MethodCallMessage) {
+        qCDebug(XdgDesktopDDEDialog) << "dialog finished without a caller, response:" << response << results;
+        return;
+    }
+    QDBusConnection::sessionBus().send(m_message.createReply({ response, results }));
+}
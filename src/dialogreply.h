@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QObject>
+#include <QPointer>
+#include <QVariantMap>
+
+#include <functional>
+
+class QDBusAbstractAdaptor;
+class QDialog;
+class Request;
+
+// Answers a portal call from a dialog without blocking the event loop. The
+// call gets a delayed reply which is sent when the dialog finishes, or as
+// cancelled when its request is closed, so any number of dialogs can be
+// open while other calls are still served.
+class DialogReply : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Fills results from the finished dialog and returns the response code
+    using ResultHandler = std::function<uint(int result, QVariantMap &results)>;
+    // Takes the finished dialog, e.g. to reuse it. The default deletes it
+    using Disposer = std::function<void(QDialog *dialog)>;
+
+    // Takes over the portal call currently handled by portal and shows dialog.
+    // dialog is handed to the disposer once it finished.
+    static DialogReply *show(QDBusAbstractAdaptor *portal,
+                             const QDBusObjectPath &handle,
+                             QDialog *dialog,
+                             bool modal,
+                             const ResultHandler &handler);
+
+    ~DialogReply() override;
+
+    inline void setDisposer(const Disposer &disposer) { m_disposer = disposer; }
+
+private:
+    DialogReply(QDialog *dialog, const QDBusMessage &message, const ResultHandler &handler);
+
+    void onFinished(int result);
+    void sendReply(uint response, const QVariantMap &results);
+
+    QDialog *m_dialog;
+    QPointer<Request> m_request;
+    QDBusMessage m_message;
+    ResultHandler m_handler;
+    Disposer m_disposer;
+    bool m_replied;
+};
@@ -3,12 +3,18 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "filechooser.h"
-#include "request.h"
+#include "dialogreply.h"
+#include "filechooserhistory.h"
+#include "filedialogpool.h"
+#include "thumbnailengine.h"
 #include "utils.h"
 
 #include <QLoggingCategory>
 #include <QFileDialog>
 #include <QDBusMetaType>
+#include <QMimeDatabase>
+#include <QThreadPool>
+#include <QTimer>
 
 // Keep in sync with qflatpakfiledialog from flatpak-platform-plugin
 Q_DECLARE_METATYPE(FileChooserPortal::Filter)
@@ -109,8 +115,86 @@ const QDBusArgument &operator>>(const QDBusArgument &arg, FileChooserPortal::Opt
 
 Q_LOGGING_CATEGORY(fileChooserCategory, "xdg-dde-filechooser")
 
+static constexpr int MimeDatabasePreloadDelay = 2000;
+
+namespace {
+struct OpenFileOptions
+{
+    // The label for the accept button. Mnemonic underlines are allowed.
+    QString accept_label;
+    // Whether to make the dialog modal. Default is yes.
+    bool modal = true;
+    // Whether to allow selection of multiple files. Default is no.
+    bool multiple = false;
+    // Whether to select for folders instead of files. Default is to select files.
+    bool directory = false;
+    QVariant filters;
+    QVariant current_filter;
+    QVariant choices;
+    // Suggested folder from which the files should be opened.
+    QString current_folder;
+};
+
+constexpr auto OpenFileSchema = std::make_tuple(optionKey("accept_label", &OpenFileOptions::accept_label),
+                                                optionKey("modal", &OpenFileOptions::modal),
+                                                optionKey("multiple", &OpenFileOptions::multiple),
+                                                optionKey("directory", &OpenFileOptions::directory),
+                                                optionKey("filters", &OpenFileOptions::filters),
+                                                optionKey("current_filter", &OpenFileOptions::current_filter),
+                                                optionKey("choices", &OpenFileOptions::choices),
+                                                optionKey("current_folder", &OpenFileOptions::current_folder));
+
+struct SaveFileOptions
+{
+    QString accept_label;
+    bool modal = true;
+    QVariant filters;
+    QVariant current_filter;
+    QVariant choices;
+    // A suggested filename.
+    QString current_name;
+    // A suggested folder to save the file in.
+    QString current_folder;
+    // The current file (when saving an existing file).
+    QString current_file;
+};
+
+constexpr auto SaveFileSchema = std::make_tuple(optionKey("accept_label", &SaveFileOptions::accept_label),
+                                                optionKey("modal", &SaveFileOptions::modal),
+                                                optionKey("filters", &SaveFileOptions::filters),
+                                                optionKey("current_filter", &SaveFileOptions::current_filter),
+                                                optionKey("choices", &SaveFileOptions::choices),
+                                                optionKey("current_name", &SaveFileOptions::current_name),
+                                                optionKey("current_folder", &SaveFileOptions::current_folder),
+                                                optionKey("current_file", &SaveFileOptions::current_file));
+
+struct SaveFilesOptions
+{
+    QString accept_label;
+    bool modal = true;
+    QVariant filters;
+    QVariant current_filter;
+    QVariant choices;
+    // Suggested folder to save the files in.
+    QString current_folder;
+    // An array of file names to be saved.
+    QStringList files;
+};
+
+constexpr auto SaveFilesSchema = std::make_tuple(optionKey("accept_label", &SaveFilesOptions::accept_label),
+                                                 optionKey("modal", &SaveFilesOptions::modal),
+                                                 optionKey("filters", &SaveFilesOptions::filters),
+                                                 optionKey("current_filter", &SaveFilesOptions::current_filter),
+                                                 optionKey("choices", &SaveFilesOptions::choices),
+                                                 optionKey("current_folder", &SaveFilesOptions::current_folder),
+                                                 optionKey("files", &SaveFilesOptions::files));
+} // namespace
+
 FileChooserPortal::FileChooserPortal(QObject *parent)
     : QDBusAbstractAdaptor(parent)
+    , m_thumbnails(new ThumbnailEngine(this))
+    , m_dialogPool(new FileDialogPool(2, m_thumbnails, this))
+    , m_history(new FileChooserHistory(this))
 {
     qCDebug(fileChooserCategory) << "init dde-filechooser";
 
@@ -122,6 +206,15 @@ FileChooserPortal::FileChooserPortal(QObject *parent)
     qDBusRegisterMetaType<Choices>();
     qDBusRegisterMetaType<Option>();
     qDBusRegisterMetaType<OptionList>();
+
+    m_filterCache.setMaxCost(32);
+    // Loading the shared-mime-info database takes a while, do it before
+    // the first dialog needs it and away from the GUI thread
+    QTimer::singleShot(MimeDatabasePreloadDelay, this, [] {
+        QThreadPool::globalInstance()->start([] {
+            QMimeDatabase().mimeTypeForName(QStringLiteral("application/octet-stream"));
+        });
+    });
 }
 
 uint FileChooserPortal::OpenFile(const QDBusObjectPath &handle,
@@ -131,8 +224,6 @@ uint FileChooserPortal::OpenFile(const QDBusObjectPath &handle,
                                  const QVariantMap &options,
                                  QVariantMap &results)
 {
-    Q_UNUSED(app_id);
-
     qCDebug(fileChooserCategory) << __FUNCTION__ << "args:"
                                  << "\n handle:" << handle.path()
                                  << "\n app_id:" << app_id
@@ -141,113 +232,87 @@ uint FileChooserPortal::OpenFile(const QDBusObjectPath &handle,
                                  << "\n options:" << options
                                  << "\n results:" << results;
 
-    // Whether to make the dialog modal. Default is yes.
-    DECLEAR_PARA_WITH_FALLBACK(modal, toBool, true);
-    // Whether to allow selection of multiple files. Default is no.
-    DECLEAR_PARA_WITH_FALLBACK(multiple, toBool, false);
-    // Whether to select for folders instead of files. Default is to select files.
-    DECLEAR_PARA_WITH_FALLBACK(directory, toBool, false);
-    // The label for the accept button. Mnemonic underlines are allowed.
-    const QString &acceptText = parseAcceptLabel(options);
+    const auto opts = decodeOptions<OpenFileOptions>(options, OpenFileSchema);
+    const QString &acceptText = parseAcceptLabel(opts.accept_label);
 
-    QStringList nameFilters;
-    QStringList mimeTypeFilters;
-    QString selectedMimeTypeFilter;
-    // mapping between filter strings and actual filters
-    QMap<QString, FilterList> allFilters;
-
-    parseFilters(options, nameFilters, mimeTypeFilters, allFilters, selectedMimeTypeFilter);
+    const CompiledFilters filters = compileFilters(opts.filters, opts.current_filter);
 
     // open directory
-    if (options.contains(QStringLiteral("directory"))) {
-        directory = options.value("directory").toBool();
-    }
-
-    if (directory && !options.contains(QStringLiteral("choices"))) {
-        QFileDialog dirDialog;
-        dirDialog.setWindowTitle(title);
-        dirDialog.setModal(modal);
-        dirDialog.setFileMode(QFileDialog::Directory);
-        dirDialog.setOptions(QFileDialog::ShowDirsOnly);
-        dirDialog.setSupportedSchemes(QStringList{QStringLiteral("file")});
+    if (opts.directory && !opts.choices.isValid()) {
+        auto dirDialog = m_dialogPool->acquire();
+        dirDialog->setWindowTitle(title);
+        dirDialog->setFileMode(QFileDialog::Directory);
+        dirDialog->setOption(QFileDialog::ShowDirsOnly);
+        dirDialog->setSupportedSchemes(QStringList{QStringLiteral("file")});
         if (!acceptText.isEmpty()) {
-            dirDialog.setLabelText(QFileDialog::Accept, acceptText);
+            dirDialog->setLabelText(QFileDialog::Accept, acceptText);
         }
 
-        dirDialog.winId(); // Trigger window creation
+        restoreHistory(dirDialog, app_id, opts.current_folder, false);
 
-        Utils::setParentWindow(&dirDialog, parent_window);
-        auto request = new Request(handle, QVariant(), &dirDialog);
-        connect(request, &Request::closeRequested, &dirDialog, &QFileDialog::reject);
+        dirDialog->winId(); // Trigger window creation
 
-        if (dirDialog.exec() != QDialog::Accepted) {
-            return 1;
-        }
-
-        const auto urls = dirDialog.selectedUrls();
-        if (urls.empty()) {
-            return 2;
-        }
+        Utils::setParentWindow(dirDialog, parent_window);
+        auto reply = DialogReply::show(this, handle, dirDialog, opts.modal, [this, dirDialog, app_id](int result, QVariantMap &results) -> uint {
+            if (result != QDialog::Accepted) {
+                return 1;
+            }
 
-        results.insert(QStringLiteral("uris"), QUrl::toStringList(urls, QUrl::FullyEncoded));
-        results.insert(QStringLiteral("writable"), true);
+            const auto urls = dirDialog->selectedUrls();
+            if (urls.empty()) {
+                return 2;
+            }
+            recordHistory(dirDialog, app_id);
 
+            results.insert(QStringLiteral("uris"), QUrl::toStringList(urls, QUrl::FullyEncoded));
+            results.insert(QStringLiteral("writable"), true);
+            return 0;
+        });
+        reply->setDisposer([this](QDialog *dialog) { recycleDialog(dialog); });
         return 0;
     }
 
     // handle choices
-    if (options.contains(QStringLiteral("choices"))) {
-        OptionList optionList = qdbus_cast<OptionList>(options.value(QStringLiteral("choices")));
+    if (opts.choices.isValid()) {
+        OptionList optionList = qdbus_cast<OptionList>(opts.choices);
         //        optionsWidget.reset(CreateChoiceControls(optionList, checkboxes, comboboxes));
     }
 
-    if (options.contains(QStringLiteral("multiple"))) {
-        multiple = options.value("multiple").toBool();
-    }
-
-    QFileDialog fileDialog;
-    Utils::setParentWindow(&fileDialog, parent_window);
-    auto request = new Request(handle, QVariant(), &fileDialog);
-    connect(request, &Request::closeRequested, &fileDialog, &QFileDialog::reject);
-    fileDialog.setWindowTitle(title);
-    fileDialog.setModal(modal);
-    fileDialog.setFileMode(multiple ? QFileDialog::FileMode::ExistingFiles : QFileDialog::FileMode::ExistingFile);
+    auto fileDialog = m_dialogPool->acquire();
+    Utils::setParentWindow(fileDialog, parent_window);
+    fileDialog->setWindowTitle(title);
+    fileDialog->setFileMode(opts.multiple ? QFileDialog::FileMode::ExistingFiles : QFileDialog::FileMode::ExistingFile);
     if (!acceptText.isEmpty()) {
-        fileDialog.setLabelText(QFileDialog::Accept, acceptText);
+        fileDialog->setLabelText(QFileDialog::Accept, acceptText);
     }
 
-    bool bMimeFilters = false;
-    if (!mimeTypeFilters.isEmpty()) {
-        fileDialog.setMimeTypeFilters(mimeTypeFilters);
-        fileDialog.selectMimeTypeFilter(selectedMimeTypeFilter);
-        bMimeFilters = true;
-    } else if (!nameFilters.isEmpty()) {
-        fileDialog.setNameFilters(nameFilters);
-    }
+    applyFilters(fileDialog, filters);
+    restoreHistory(fileDialog, app_id, opts.current_folder, !opts.current_filter.isValid());
+
+    auto reply = DialogReply::show(this, handle, fileDialog, opts.modal, [this, fileDialog, app_id, filters](int result, QVariantMap &results) -> uint {
+        if (result != QDialog::Accepted)
+            return 1;
 
-    if (fileDialog.exec() != QDialog::Accepted)
-        return 1;
+        const auto &urls = fileDialog->selectedUrls();
+        if (urls.isEmpty()) {
+            qCDebug(fileChooserCategory) << "Failed to open file: no local file selected";
+            return 2;
+        }
+        recordHistory(fileDialog, app_id);
 
-    const auto &urls = fileDialog.selectedUrls();
-    if (urls.isEmpty()) {
-        qCDebug(fileChooserCategory) << "Failed to open file: no local file selected";
-        return 2;
-    }
+        results.insert(QStringLiteral("uris"), QUrl::toStringList(urls, QUrl::FullyEncoded));
+        results.insert(QStringLiteral("writable"), true);
+        results.insert(QStringLiteral("choices"), ""); // TODO
 
-    results.insert(QStringLiteral("uris"), QUrl::toStringList(urls, QUrl::FullyEncoded));
-    results.insert(QStringLiteral("writable"), true);
-    results.insert(QStringLiteral("choices"), ""); // TODO
+        // try to map current filter back to one of the predefined ones
+        const QString selectedFilter = fileDialog->selectedNameFilter();
+        if (filters.filterLists.contains(selectedFilter)) {
+            results.insert(QStringLiteral("current_filter"), QVariant::fromValue<FilterList>(filters.filterLists.value(selectedFilter)));
+        }
 
-    // try to map current filter back to one of the predefined ones
-    QString selectedFilter;
-    if (bMimeFilters) {
-        selectedFilter = fileDialog.selectedMimeTypeFilter();
-    } else {
-        selectedFilter = fileDialog.selectedNameFilter();
-    }
-    if (allFilters.contains(selectedFilter)) {
-        results.insert(QStringLiteral("current_filter"), QVariant::fromValue<FilterList>(allFilters.value(selectedFilter)));
-    }
+        return 0;
+    });
+    reply->setDisposer([this](QDialog *dialog) { recycleDialog(dialog); });
 
     return 0;
 }
@@ -268,60 +333,47 @@ uint FileChooserPortal::SaveFile(const QDBusObjectPath &handle,
                                  << "\n results:" << results;
 
 
-    // Whether to make the dialog modal. Default is yes.
-    DECLEAR_PARA_WITH_FALLBACK(modal, toBool, true);
-    // The label for the accept button. Mnemonic underlines are allowed.
-    const QString &acceptText = parseAcceptLabel(options);
-    // A suggested filename.
-    DECLEAR_PARA(current_name, toString);
-    // A suggested folder to save the file in.
-    DECLEAR_PARA(current_folder, toString);
-    // The current file (when saving an existing file).
-    DECLEAR_PARA(current_file, toString);
+    const auto opts = decodeOptions<SaveFileOptions>(options, SaveFileSchema);
+    const QString &acceptText = parseAcceptLabel(opts.accept_label);
 
-    QStringList nameFilters;
-    QStringList mimeTypeFilters;
-    QString selectedMimeTypeFilter;
-    // mapping between filter strings and actual filters
-    QMap<QString, FilterList> allFilters;
-    parseFilters(options, nameFilters, mimeTypeFilters, allFilters, selectedMimeTypeFilter);
+    const CompiledFilters filters = compileFilters(opts.filters, opts.current_filter);
 
-    if (options.contains(QStringLiteral("choices"))) {
-        OptionList optionList = qdbus_cast<OptionList>(options.value(QStringLiteral("choices")));
+    if (opts.choices.isValid()) {
+        OptionList optionList = qdbus_cast<OptionList>(opts.choices);
     }
 
-    QFileDialog fileDialog;
-    Utils::setParentWindow(&fileDialog, parent_window);
-    auto request = new Request(handle, QVariant(), &fileDialog);
-    connect(request, &Request::closeRequested, &fileDialog, &QFileDialog::reject);
-
-    fileDialog.setWindowTitle(title);
-    fileDialog.setModal(modal);
-    fileDialog.setAcceptMode(QFileDialog::AcceptSave);
-    fileDialog.setOption(QFileDialog::DontConfirmOverwrite, false);
-    fileDialog.setDirectory(current_folder);
-    fileDialog.selectFile(current_file);
-    fileDialog.setFileMode(QFileDialog::FileMode::ExistingFile);
+    auto fileDialog = m_dialogPool->acquire();
+    Utils::setParentWindow(fileDialog, parent_window);
+
+    fileDialog->setWindowTitle(title);
+    fileDialog->setAcceptMode(QFileDialog::AcceptSave);
+    fileDialog->setOption(QFileDialog::DontConfirmOverwrite, false);
+    fileDialog->setFileMode(QFileDialog::FileMode::ExistingFile);
     if (!acceptText.isEmpty()) {
-        fileDialog.setLabelText(QFileDialog::Accept, acceptText);
+        fileDialog->setLabelText(QFileDialog::Accept, acceptText);
     }
 
-    bool bMimeFilters = false;
-    if (!mimeTypeFilters.isEmpty()) {
-        fileDialog.setMimeTypeFilters(mimeTypeFilters);
-        fileDialog.selectMimeTypeFilter(selectedMimeTypeFilter);
-        bMimeFilters = true;
-    } else if (!nameFilters.isEmpty()) {
-        fileDialog.setNameFilters(nameFilters);
-    }
+    applyFilters(fileDialog, filters);
+    restoreHistory(fileDialog, app_id, opts.current_folder, !opts.current_filter.isValid());
+    // After the directory, an existing file brings its own folder along
+    if (!opts.current_file.isEmpty())
+        fileDialog->selectFile(opts.current_file);
+    else if (!opts.current_name.isEmpty())
+        fileDialog->selectFile(opts.current_name);
 
-    if (fileDialog.exec() != QDialog::Accepted)
-        return 1;
+    auto reply = DialogReply::show(this, handle, fileDialog, opts.modal, [this, fileDialog, app_id](int result, QVariantMap &results) -> uint {
+        if (result != QDialog::Accepted)
+            return 1;
 
-    const auto &urls = fileDialog.selectedUrls();
-    results.insert(QStringLiteral("uris"), QUrl::toStringList(urls, QUrl::FullyEncoded));
-    results.insert(QStringLiteral("choices"), ""); // TODO
-    results.insert(QStringLiteral("current_filter"), ""); // TODO
+        recordHistory(fileDialog, app_id);
+        const auto &urls = fileDialog->selectedUrls();
+        results.insert(QStringLiteral("uris"), QUrl::toStringList(urls, QUrl::FullyEncoded));
+        results.insert(QStringLiteral("choices"), ""); // TODO
+        results.insert(QStringLiteral("current_filter"), ""); // TODO
+
+        return 0;
+    });
+    reply->setDisposer([this](QDialog *dialog) { recycleDialog(dialog); });
 
     return 0;
 }
@@ -337,67 +389,77 @@ uint FileChooserPortal::SaveFiles(const QDBusObjectPath &handle, const QString &
                                  << "\n results:" << results;
 
 
-    // Whether the dialog should be modal. Default is yes.
-    DECLEAR_PARA_WITH_FALLBACK(modal, toBool, true);
-    // Label for the accept button. Mnemonic underlines are allowed.
-    const QString &acceptText = parseAcceptLabel(options);
+    const auto opts = decodeOptions<SaveFilesOptions>(options, SaveFilesSchema);
+    const QString &acceptText = parseAcceptLabel(opts.accept_label);
 
-    // Suggested folder to save the files in. The byte array is expected to be null-terminated.
-    DECLEAR_PARA(current_folder, toString);
-    // An array of file names to be saved. The array and byte arrays are expected to be null-terminated.
-    DECLEAR_PARA(files, toStringList);
+    const CompiledFilters filters = compileFilters(opts.filters, opts.current_filter);
 
-    QStringList nameFilters;
-    QStringList mimeTypeFilters;
-    QString selectedMimeTypeFilter;
-    // mapping between filter strings and actual filters
-    QMap<QString, FilterList> allFilters;
-    parseFilters(options, nameFilters, mimeTypeFilters, allFilters, selectedMimeTypeFilter);
-
-    if (options.contains(QStringLiteral("choices"))) {
-        OptionList optionList = qdbus_cast<OptionList>(options.value(QStringLiteral("choices")));
+    if (opts.choices.isValid()) {
+        OptionList optionList = qdbus_cast<OptionList>(opts.choices);
     }
 
-    QFileDialog fileDialog;
-    Utils::setParentWindow(&fileDialog, parent_window);
-
-    auto *request = new Request(handle, QVariant(), this);
-    connect(request, &Request::closeRequested, &fileDialog, &QFileDialog::reject);
+    auto fileDialog = m_dialogPool->acquire();
+    Utils::setParentWindow(fileDialog, parent_window);
 
-    fileDialog.setWindowTitle(title);
-    fileDialog.setModal(modal);
-    fileDialog.setAcceptMode(QFileDialog::AcceptSave);
-    fileDialog.setOption(QFileDialog::DontConfirmOverwrite, false);
-    fileDialog.setDirectory(current_folder);
-    fileDialog.setFileMode(QFileDialog::FileMode::ExistingFiles);
+    fileDialog->setWindowTitle(title);
+    fileDialog->setAcceptMode(QFileDialog::AcceptSave);
+    fileDialog->setOption(QFileDialog::DontConfirmOverwrite, false);
+    fileDialog->setFileMode(QFileDialog::FileMode::ExistingFiles);
     if (!acceptText.isEmpty()) {
-        fileDialog.setLabelText(QFileDialog::Accept, acceptText);
+        fileDialog->setLabelText(QFileDialog::Accept, acceptText);
     }
 
-    bool bMimeFilters = false;
-    if (!mimeTypeFilters.isEmpty()) {
-        fileDialog.setMimeTypeFilters(mimeTypeFilters);
-        fileDialog.selectMimeTypeFilter(selectedMimeTypeFilter);
-        bMimeFilters = true;
-    } else if (!nameFilters.isEmpty()) {
-        fileDialog.setNameFilters(nameFilters);
-    }
+    applyFilters(fileDialog, filters);
+    restoreHistory(fileDialog, app_id, opts.current_folder, !opts.current_filter.isValid());
 
-    if (fileDialog.exec() != QDialog::Accepted)
-        return 1;
+    auto reply = DialogReply::show(this, handle, fileDialog, opts.modal, [this, fileDialog, app_id](int result, QVariantMap &results) -> uint {
+        if (result != QDialog::Accepted)
+            return 1;
 
-    const auto &urls = fileDialog.selectedUrls();
-    results.insert(QStringLiteral("uris"), QUrl::toStringList(urls, QUrl::FullyEncoded));
-    results.insert(QStringLiteral("choices"), ""); // TODO
+        recordHistory(fileDialog, app_id);
+        const auto &urls = fileDialog->selectedUrls();
+        results.insert(QStringLiteral("uris"), QUrl::toStringList(urls, QUrl::FullyEncoded));
+        results.insert(QStringLiteral("choices"), ""); // TODO
+
+        return 0;
+    });
+    reply->setDisposer([this](QDialog *dialog) { recycleDialog(dialog); });
 
     return 0;
 }
 
-QString FileChooserPortal::parseAcceptLabel(const QVariantMap &options)
+void FileChooserPortal::recycleDialog(QDialog *dialog)
+{
+    m_dialogPool->release(static_cast<QFileDialog *>(dialog));
+}
+
+void FileChooserPortal::restoreHistory(QFileDialog *dialog, const QString &appId, const QString &currentFolder, bool restoreFilter)
+{
+    const auto entry = m_history->entry(appId);
+    // The app's own suggestion wins over what was used last time
+    const QString directory = !currentFolder.isEmpty() ? currentFolder : entry.lastDirectory;
+    if (!directory.isEmpty()) {
+        FileChooserHistory::prefetch(directory);
+        dialog->setDirectory(directory);
+    }
+    dialog->setHistory(entry.recentDirectories);
+
+    if (!restoreFilter || entry.lastFilter.isEmpty())
+        return;
+    if (dialog->nameFilters().contains(entry.lastFilter))
+        dialog->selectNameFilter(entry.lastFilter);
+}
+
+void FileChooserPortal::recordHistory(QFileDialog *dialog, const QString &appId)
+{
+    m_history->record(appId, dialog->directory().absolutePath(), dialog->selectedNameFilter());
+}
+
+QString FileChooserPortal::parseAcceptLabel(const QString &label)
 {
     QString acceptLabel;
-    if (options.contains(QStringLiteral("accept_label"))) {
-        acceptLabel = options.value(QStringLiteral("accept_label")).toString();
+    if (!label.isEmpty()) {
+        acceptLabel = label;
         // 'accept_label' allows mnemonic underlines, but Qt uses '&' character, so replace/escape accordingly
         // to keep literal '&'s and transform mnemonic underlines to the Qt equivalent using '&' for mnemonic
         acceptLabel.replace(QChar::fromLatin1('&'), QStringLiteral("&&"));
@@ -409,52 +471,95 @@ QString FileChooserPortal::parseAcceptLabel(const QVariantMap &options)
     return acceptLabel;
 }
 
-void FileChooserPortal::parseFilters(const QVariantMap &options,
-                                     QStringList &nameFilters,
-                                     QStringList &mimeTypeFilters,
-                                     QMap<QString, FilterList> &allFilters,
-                                     QString &selectedMimeTypeFilter)
+FileChooserPortal::CompiledFilters FileChooserPortal::compileFilters(const QVariant &filters, const QVariant &current_filter)
 {
-    if (options.contains(QStringLiteral("filters"))) {
-        const FilterListList filterListList = qdbus_cast<FilterListList>(options.value(QStringLiteral("filters")));
-        for (const FilterList &filterList : filterListList) {
-            QStringList filterStrings;
-            for (const Filter &filterStruct : filterList.filters) {
-                // a glob-style pattern (indicated by 0) or a mimetype (indicated by 1)
-                if (filterStruct.type == 0) {
-                    filterStrings << filterStruct.filterString;
-                } else {
-                    mimeTypeFilters << filterStruct.filterString;
-                    allFilters[filterStruct.filterString] = filterList;
-                }
-            }
-
-            if (!filterStrings.isEmpty()) {
-                QString userVisibleName = filterList.userVisibleName;
-                const QString filterString = filterStrings.join(QLatin1Char(' '));
-                const QString nameFilter = QStringLiteral("%1(%2)").arg(userVisibleName, filterString);
-                nameFilters << nameFilter;
-                allFilters[filterList.userVisibleName] = filterList;
-            }
-        }
+    const FilterListList filterListList = qdbus_cast<FilterListList>(filters);
+    const FilterList currentFilter = qdbus_cast<FilterList>(current_filter);
+
+    // Apps tend to pass the same filters every time they open a dialog
+    QString key;
+    for (const FilterList &filterList : filterListList) {
+        key += filterList.userVisibleName + QChar(0x1e);
+        for (const Filter &filterStruct : filterList.filters)
+            key += QString::number(filterStruct.type) + filterStruct.filterString + QChar(0x1f);
     }
+    key += QChar(0x1d) + currentFilter.userVisibleName;
+    for (const Filter &filterStruct : currentFilter.filters)
+        key += QString::number(filterStruct.type) + filterStruct.filterString + QChar(0x1f);
+
+    if (const CompiledFilters *cached = m_filterCache.object(key))
+        return *cached;
+
+    auto compiled = new CompiledFilters;
+    parseFilters(filterListList, currentFilter, *compiled);
+    const CompiledFilters result = *compiled;
+    m_filterCache.insert(key, compiled);
+    return result;
+}
+
+void FileChooserPortal::applyFilters(QFileDialog *dialog, const CompiledFilters &filters)
+{
+    if (filters.nameFilters.isEmpty())
+        return;
+    dialog->setNameFilters(filters.nameFilters);
+    if (!filters.selectedNameFilter.isEmpty())
+        dialog->selectNameFilter(filters.selectedNameFilter);
+}
 
-    if (options.contains(QStringLiteral("current_filter"))) {
-        FilterList filterList = qdbus_cast<FilterList>(options.value(QStringLiteral("current_filter")));
-        // only one set of data is valid
-        if (filterList.filters.size() != 1) {
-            qCDebug(fileChooserCategory) << "Ignoring 'current_filter' parameter with 0 or multiple filters specified.";
-            return;
+void FileChooserPortal::parseFilters(const FilterListList &filterListList, const FilterList &currentFilter, CompiledFilters &compiled)
+{
+    QMimeDatabase mimeDatabase;
+    // Mime types are translated here once, QFileDialog::setMimeTypeFilters would do it on every call
+    auto mimeTypeNameFilter = [&mimeDatabase](const QString &name) {
+        if (name == QLatin1String("application/octet-stream"))
+            return QFileDialog::tr("All files (*)");
+        return mimeDatabase.mimeTypeForName(name).filterString();
+    };
+
+    for (const FilterList &filterList : filterListList) {
+        QStringList filterStrings;
+        for (const Filter &filterStruct : filterList.filters) {
+            // a glob-style pattern (indicated by 0) or a mimetype (indicated by 1)
+            if (filterStruct.type == 0) {
+                filterStrings << filterStruct.filterString;
+            } else {
+                const QString nameFilter = mimeTypeNameFilter(filterStruct.filterString);
+                if (nameFilter.isEmpty() || compiled.filterLists.contains(nameFilter))
+                    continue;
+                compiled.nameFilters << nameFilter;
+                compiled.filterLists.insert(nameFilter, filterList);
+            }
         }
 
-        Filter filterStruct = filterList.filters.at(0);
-        if (filterStruct.type == 0) {
+        if (!filterStrings.isEmpty()) {
             QString userVisibleName = filterList.userVisibleName;
-            QString nameFilter = QStringLiteral("%1|(%2)").arg(filterStruct.filterString, userVisibleName);
-            nameFilters.removeAll(nameFilter);
-            nameFilters.push_front(nameFilter);
-        } else {
-            selectedMimeTypeFilter = filterStruct.filterString;
+            const QString filterString = filterStrings.join(QLatin1Char(' '));
+            const QString nameFilter = QStringLiteral("%1(%2)").arg(userVisibleName, filterString);
+            compiled.nameFilters << nameFilter;
+            compiled.filterLists.insert(nameFilter, filterList);
         }
     }
+
+    if (currentFilter.filters.isEmpty())
+        return;
+    // only one set of data is valid
+    if (currentFilter.filters.size() != 1) {
+        qCDebug(fileChooserCategory) << "Ignoring 'current_filter' parameter with 0 or multiple filters specified.";
+        return;
+    }
+
+    Filter filterStruct = currentFilter.filters.at(0);
+    if (filterStruct.type == 0) {
+        QString userVisibleName = currentFilter.userVisibleName;
+        QString nameFilter = QStringLiteral("%1(%2)").arg(userVisibleName, filterStruct.filterString);
+        compiled.nameFilters.removeAll(nameFilter);
+        compiled.nameFilters.push_front(nameFilter);
+        if (!compiled.filterLists.contains(nameFilter))
+            compiled.filterLists.insert(nameFilter, currentFilter);
+        compiled.selectedNameFilter = nameFilter;
+    } else {
+        const QString nameFilter = mimeTypeNameFilter(filterStruct.filterString);
+        if (compiled.filterLists.contains(nameFilter))
+            compiled.selectedNameFilter = nameFilter;
+    }
 }
@@ -4,10 +4,17 @@
 
 #pragma once
 
+#include <QCache>
 #include <QDBusAbstractAdaptor>
 #include <QDBusObjectPath>
 #include <qobjectdefs.h>
 
+class FileChooserHistory;
+class FileDialogPool;
+class QDialog;
+class QFileDialog;
+class ThumbnailEngine;
+
 class FileChooserPortal : public QDBusAbstractAdaptor
 {
     Q_OBJECT
@@ -65,10 +72,22 @@ public slots:
                   QVariantMap &results);
 
 private:
-    QString parseAcceptLabel(const QVariantMap &options);
-    void parseFilters(const QVariantMap &options,
-                                           QStringList &nameFilters,
-                                           QStringList &mimeTypeFilters,
-                                           QMap<QString, FilterList> &allFilters,
-                                           QString &selectedMimeTypeFilter);
+    void recycleDialog(QDialog *dialog);
+    void restoreHistory(QFileDialog *dialog, const QString &appId, const QString &currentFolder, bool restoreFilter);
+    void recordHistory(QFileDialog *dialog, const QString &appId);
+    QString parseAcceptLabel(const QString &label);
+    // Filters as the dialog takes them, mime types already translated
+    struct CompiledFilters {
+        QStringList nameFilters;
+        QHash<QString, FilterList> filterLists; // name filter -> the list it came from
+        QString selectedNameFilter;
+    };
+    CompiledFilters compileFilters(const QVariant &filters, const QVariant &current_filter);
+    void applyFilters(QFileDialog *dialog, const CompiledFilters &filters);
+    void parseFilters(const FilterListList &filterListList, const FilterList &currentFilter, CompiledFilters &compiled);
+
+    ThumbnailEngine *m_thumbnails;
+    FileDialogPool *m_dialogPool;
+    FileChooserHistory *m_history;
+    QCache<QString, CompiledFilters> m_filterCache;
 };
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "filechooserhistory.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QTimer>
+
+Q_LOGGING_CATEGORY(XdgDesktopDDEHistory, "xdg-dde-filechooser-history")
+
+static constexpr quint32 HistoryMagic = 0x46434831; // "FCH1"
+static constexpr int SaveDelay = 2000;
+static constexpr int MaxRecentDirectories = 10;
+
+static void writeHistory(const QString &fileName, const QHash<QString, FileChooserHistory::Entry> &entries)
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(XdgDesktopDDEHistory) << "Failed to open" << fileName << file.errorString();
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << HistoryMagic << quint32(entries.size());
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+        stream << it.key() << it->lastDirectory << it->lastFilter << it->recentDirectories;
+    if (!file.commit())
+        qCWarning(XdgDesktopDDEHistory) << "Failed to write" << fileName << file.errorString();
+}
+
+FileChooserHistory::FileChooserHistory(QObject *parent)
+    : QObject(parent)
+    , m_fileName(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+                 + QStringLiteral("/xdg-desktop-portal-dde/filechooser-history"))
+    , m_loaded(false)
+    , m_saveTimer(new QTimer(this))
+{
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(SaveDelay);
+    connect(m_saveTimer, &QTimer::timeout, this, &FileChooserHistory::save);
+    m_writer.setMaxThreadCount(1);
+}
+
+FileChooserHistory::~FileChooserHistory()
+{
+    if (m_saveTimer->isActive())
+        save();
+    m_writer.waitForDone();
+}
+
+FileChooserHistory::Entry FileChooserHistory::entry(const QString &appId)
+{
+    load();
+    return m_entries.value(appId);
+}
+
+void FileChooserHistory::record(const QString &appId, const QString &directory, const QString &filter)
+{
+    if (directory.isEmpty())
+        return;
+    load();
+    Entry &entry = m_entries[appId];
+    if (entry.lastDirectory == directory && entry.lastFilter == filter)
+        return;
+    entry.lastDirectory = directory;
+    entry.lastFilter = filter;
+    entry.recentDirectories.removeAll(directory);
+    entry.recentDirectories.prepend(directory);
+    while (entry.recentDirectories.size() > MaxRecentDirectories)
+        entry.recentDirectories.removeLast();
+    scheduleSave();
+}
+
+void FileChooserHistory::prefetch(const QString &directory)
+{
+    if (directory.isEmpty())
+        return;
+    QThreadPool::globalInstance()->start([directory] {
+        // Stat every entry, the way the dialog's model will
+        const auto entries = QDir(directory).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+        for (const QFileInfo &info : entries)
+            info.lastModified();
+    });
+}
+
+void FileChooserHistory::load()
+{
+    if (m_loaded)
+        return;
+    m_loaded = true;
+
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 count = 0;
+    stream >> magic >> count;
+    if (magic != HistoryMagic) {
+        qCWarning(XdgDesktopDDEHistory) << "Ignoring history with unknown format" << m_fileName;
+        return;
+    }
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString appId;
+        Entry entry;
+        stream >> appId >> entry.lastDirectory >> entry.lastFilter >> entry.recentDirectories;
+        if (stream.status() == QDataStream::Ok)
+            m_entries.insert(appId, entry);
+    }
+}
+
+void FileChooserHistory::scheduleSave()
+{
+    if (!m_saveTimer->isActive())
+        m_saveTimer->start();
+}
+
+void FileChooserHistory::save()
+{
+    m_saveTimer->stop();
+    // The writer works on a snapshot, later changes schedule another write
+    m_writer.start([fileName = m_fileName, entries = m_entries] {
+        writeHistory(fileName, entries);
+    });
+}
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+
+class QTimer;
+
+// Remembers per app where its file chooser was last used. Changes are
+// collected for a while and written by a background thread, one write at
+// a time, so a burst of dialogs costs a single small write.
+class FileChooserHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry
+    {
+        QString lastDirectory;
+        QString lastFilter; // name filter or mime type, as the dialog shows it
+        QStringList recentDirectories; // most recent first
+    };
+
+    explicit FileChooserHistory(QObject *parent = nullptr);
+    ~FileChooserHistory() override;
+
+    Entry entry(const QString &appId);
+    void record(const QString &appId, const QString &directory, const QString &filter);
+
+    // Lists directory on a worker thread so the dialog finds it in the caches
+    static void prefetch(const QString &directory);
+
+private:
+    void load();
+    void scheduleSave();
+    void save();
+
+    QString m_fileName;
+    bool m_loaded;
+    QHash<QString, Entry> m_entries;
+    QTimer *m_saveTimer;
+    QThreadPool m_writer;
+};
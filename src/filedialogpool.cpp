@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "filedialogpool.h"
+#include "filepreview.h"
+
+#include <QDir>
+#include <QFileDialog>
+#include <QLoggingCategory>
+#include <QTimer>
+#include <QWindow>
+
+Q_LOGGING_CATEGORY(XdgDesktopDDEDialogPool, "xdg-dde-dialog-pool")
+
+// Leave the session startup alone before building anything
+static constexpr int StartupDelay = 3000;
+
+FileDialogPool::FileDialogPool(int capacity, ThumbnailEngine *thumbnails, QObject *parent)
+    : QObject(parent)
+    , m_capacity(capacity)
+    , m_thumbnails(thumbnails)
+    , m_warmUpTimer(new QTimer(this))
+{
+    // A zero interval timer fires once the event loop has nothing else to do
+    m_warmUpTimer->setSingleShot(true);
+    connect(m_warmUpTimer, &QTimer::timeout, this, &FileDialogPool::warmUp);
+    QTimer::singleShot(StartupDelay, this, &FileDialogPool::scheduleWarmUp);
+}
+
+FileDialogPool::~FileDialogPool()
+{
+    for (const auto &dialog : std::as_const(m_dialogs))
+        delete dialog;
+}
+
+QFileDialog *FileDialogPool::acquire()
+{
+    QFileDialog *dialog = nullptr;
+    while (!dialog && !m_dialogs.isEmpty())
+        dialog = m_dialogs.takeLast();
+    if (!dialog) {
+        qCDebug(XdgDesktopDDEDialogPool) << "pool is empty, building a dialog on demand";
+        dialog = createDialog();
+    }
+    scheduleWarmUp();
+    return dialog;
+}
+
+void FileDialogPool::release(QFileDialog *dialog)
+{
+    if (!dialog)
+        return;
+    if (m_dialogs.size() >= m_capacity) {
+        dialog->deleteLater();
+        return;
+    }
+    reset(dialog);
+    m_dialogs.append(dialog);
+}
+
+QFileDialog *FileDialogPool::createDialog() const
+{
+    auto dialog = new QFileDialog;
+    // This process is the native dialog provider, and the preview needs the widgets
+    dialog->setOption(QFileDialog::DontUseNativeDialog);
+    new FilePreview(dialog, m_thumbnails);
+    // Loads the platform theme, icon provider and starts listing the home directory
+    dialog->setDirectory(QDir::homePath());
+    dialog->winId(); // Trigger window creation
+    return dialog;
+}
+
+void FileDialogPool::reset(QFileDialog *dialog) const
+{
+    // A foreign transient parent is only known to the dialog, drop it here
+    // or it would stay alive and keep the next caller's dialog attached to it
+    if (QWindow *window = dialog->windowHandle()) {
+        QWindow *transientParent = window->transientParent();
+        window->setTransientParent(nullptr);
+        if (transientParent && transientParent->type() == Qt::ForeignWindow)
+            transientParent->deleteLater();
+    }
+    dialog->setWindowModality(Qt::NonModal);
+    dialog->setWindowTitle(QString());
+
+    dialog->setAcceptMode(QFileDialog::AcceptOpen);
+    dialog->setFileMode(QFileDialog::AnyFile);
+    dialog->setOptions(QFileDialog::DontUseNativeDialog);
+    dialog->setSupportedSchemes(QStringList());
+    dialog->setDefaultSuffix(QString());
+    // An empty text brings the default label back
+    dialog->setLabelText(QFileDialog::Accept, QString());
+
+    dialog->setNameFilters(QStringList());
+    dialog->setMimeTypeFilters(QStringList());
+    dialog->setDirectory(QDir::homePath());
+    dialog->selectFile(QString());
+}
+
+void FileDialogPool::warmUp()
+{
+    m_dialogs.removeAll(nullptr);
+    if (m_dialogs.size() >= m_capacity)
+        return;
+    m_dialogs.append(createDialog());
+    qCDebug(XdgDesktopDDEDialogPool) << "pre-built file dialog, pool size:" << m_dialogs.size();
+    scheduleWarmUp();
+}
+
+void FileDialogPool::scheduleWarmUp()
+{
+    if (m_dialogs.size() < m_capacity && !m_warmUpTimer->isActive())
+        m_warmUpTimer->start(0);
+}
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+
+class QFileDialog;
+class QTimer;
+class ThumbnailEngine;
+
+// Keeps a few hidden file dialogs around so a file chooser call does not
+// pay for building the widget tree, file system model and native window.
+// Dialogs are built one per idle event loop pass and reset when returned.
+class FileDialogPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Dialogs get a preview pane fed by thumbnails
+    FileDialogPool(int capacity, ThumbnailEngine *thumbnails, QObject *parent = nullptr);
+    ~FileDialogPool() override;
+
+    // Returns a reset, hidden dialog. Builds one if the pool ran dry
+    QFileDialog *acquire();
+    // Takes a finished dialog back, it is deleted when the pool is full
+    void release(QFileDialog *dialog);
+
+private:
+    QFileDialog *createDialog() const;
+    void reset(QFileDialog *dialog) const;
+    void warmUp();
+    void scheduleWarmUp();
+
+    int m_capacity;
+    ThumbnailEngine *m_thumbnails;
+    QList<QPointer<QFileDialog>> m_dialogs;
+    QTimer *m_warmUpTimer;
+};
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "filepreview.h"
+#include "thumbnailengine.h"
+
+#include <QAbstractItemView>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFileSystemModel>
+#include <QGridLayout>
+#include <QImageReader>
+#include <QScrollBar>
+#include <QSet>
+#include <QTimer>
+
+// Wait for scrolling to settle before touching the queue
+static constexpr int PrefetchDelay = 100;
+
+static bool canThumbnail(const QString &path)
+{
+    static const QSet<QByteArray> formats = [] {
+        const auto list = QImageReader::supportedImageFormats();
+        return QSet<QByteArray>(list.cbegin(), list.cend());
+    }();
+    return formats.contains(QFileInfo(path).suffix().toLower().toLatin1());
+}
+
+FilePreview::FilePreview(QFileDialog *dialog, ThumbnailEngine *engine)
+    : QLabel(dialog)
+    , m_engine(engine)
+    , m_prefetchTimer(new QTimer(this))
+{
+    setAlignment(Qt::AlignCenter);
+    setFixedWidth(160);
+    setMinimumHeight(160);
+
+    // Next to the file views, spanning the rows they take
+    if (auto grid = qobject_cast<QGridLayout *>(dialog->layout()))
+        grid->addWidget(this, 1, grid->columnCount(), 1, 1);
+
+    // Object names of the views in QFileDialog's ui
+    for (const char *name : { "listView", "treeView" }) {
+        auto view = dialog->findChild<QAbstractItemView *>(QLatin1String(name));
+        if (!view)
+            continue;
+        m_views.append(view);
+        connect(view->verticalScrollBar(), &QScrollBar::valueChanged, m_prefetchTimer, qOverload<>(&QTimer::start));
+        connect(view->horizontalScrollBar(), &QScrollBar::valueChanged, m_prefetchTimer, qOverload<>(&QTimer::start));
+    }
+    if (auto model = dialog->findChild<QFileSystemModel *>())
+        connect(model, &QFileSystemModel::directoryLoaded, m_prefetchTimer, qOverload<>(&QTimer::start));
+
+    m_prefetchTimer->setSingleShot(true);
+    m_prefetchTimer->setInterval(PrefetchDelay);
+    connect(m_prefetchTimer, &QTimer::timeout, this, &FilePreview::prefetchVisible);
+    connect(dialog, &QFileDialog::currentChanged, this, &FilePreview::showPreview);
+    connect(dialog, &QFileDialog::finished, this, [this] {
+        showPreview(QString());
+    });
+    connect(engine, &ThumbnailEngine::thumbnailReady, this, &FilePreview::onThumbnailReady);
+}
+
+void FilePreview::showPreview(const QString &path)
+{
+    m_path = path;
+    clear();
+    if (m_engine && !path.isEmpty() && canThumbnail(path))
+        m_engine->request(path, ThumbnailEngine::Visible);
+}
+
+void FilePreview::onThumbnailReady(const QString &path, const QImage &image)
+{
+    if (path == m_path)
+        setPixmap(QPixmap::fromImage(image));
+}
+
+void FilePreview::prefetchVisible()
+{
+    if (!m_engine || !isVisible())
+        return;
+
+    QSet<QString> visible;
+    for (QAbstractItemView *view : std::as_const(m_views)) {
+        if (!view->isVisible() || !view->model())
+            continue;
+        const QRect viewport = view->viewport()->rect();
+        const QModelIndex root = view->rootIndex();
+        const int rows = view->model()->rowCount(root);
+        // Both views lay rows out in order, the visible ones are the rows between
+        // the corners. A corner on empty space falls back to the end of the model.
+        const QModelIndex first = view->indexAt(viewport.topLeft());
+        const QModelIndex last = view->indexAt(viewport.bottomRight());
+        const int firstRow = first.isValid() && first.parent() == root ? first.row() : 0;
+        const int lastRow = last.isValid() && last.parent() == root ? last.row() : rows - 1;
+        bool seen = false;
+        for (int row = firstRow; row <= lastRow; ++row) {
+            const QModelIndex index = view->model()->index(row, 0, root);
+            if (!view->visualRect(index).intersects(viewport)) {
+                if (seen)
+                    break;
+                continue;
+            }
+            seen = true;
+            const QString path = index.data(QFileSystemModel::FilePathRole).toString();
+            if (canThumbnail(path))
+                visible.insert(path);
+        }
+    }
+
+    // Whatever scrolled out of view is not worth decoding anymore
+    m_engine->cancelPrefetch(visible);
+    for (const QString &path : std::as_const(visible))
+        m_engine->request(path, ThumbnailEngine::Prefetch);
+}
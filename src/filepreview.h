@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QLabel>
+#include <QList>
+#include <QPointer>
+
+class QAbstractItemView;
+class QFileDialog;
+class QTimer;
+class ThumbnailEngine;
+
+// Preview pane of a widget based QFileDialog. The current file is shown
+// from the thumbnail engine, files scrolled into view are thumbnailed in
+// the background so moving through them shows previews right away.
+class FilePreview : public QLabel
+{
+    Q_OBJECT
+
+public:
+    FilePreview(QFileDialog *dialog, ThumbnailEngine *engine);
+
+private:
+    void showPreview(const QString &path);
+    void onThumbnailReady(const QString &path, const QImage &image);
+    void prefetchVisible();
+
+    QPointer<ThumbnailEngine> m_engine;
+    QList<QAbstractItemView *> m_views;
+    QTimer *m_prefetchTimer;
+    QString m_path;
+};
@@ -21,6 +21,8 @@ uint GlobalShortcutPortal::CreateSession(const QDBusObjectPath &handle,
                                         QVariantMap &results)
 {
     qCDebug(XdgDesktopDDEGlobalShortCut) << "create session";
+    // Nothing registers the shortcuts with the compositor or emits Activated
+    // yet, a session would tell the app its shortcuts work when they never fire
     return 1;
 }
 
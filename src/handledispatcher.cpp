@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "handledispatcher.h"
+#include "request.h"
+#include "session.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusServiceWatcher>
+#include <QDBusVariant>
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(XdgDesktopDDEHandle, "xdg-dde-handle")
+
+static const QString RequestRoot = QStringLiteral("/org/freedesktop/portal/desktop/request");
+static const QString SessionRoot = QStringLiteral("/org/freedesktop/portal/desktop/session");
+static const QString RequestInterface = QStringLiteral("org.freedesktop.impl.portal.Request");
+static const QString SessionInterface = QStringLiteral("org.freedesktop.impl.portal.Session");
+static const QString PropertiesInterface = QStringLiteral("org.freedesktop.DBus.Properties");
+
+static bool isBelow(const QString &path, const QString &root)
+{
+    return path.size() > root.size() + 1 && path.startsWith(root) && path.at(root.size()) == QLatin1Char('/');
+}
+
+// Handles look like <root>/<sender>/<token>, sender being the unique name of
+// the app without the leading colon and with dots replaced by underscores
+static QString handlePeer(const QString &path, const QString &root)
+{
+    const QString sender = path.mid(root.size() + 1).section(QLatin1Char('/'), 0, 0);
+    if (sender.isEmpty())
+        return QString();
+    return QLatin1Char(':') + QString(sender).replace(QLatin1Char('_'), QLatin1Char('.'));
+}
+
+HandleDispatcher::HandleDispatcher(QObject *parent)
+    : QDBusVirtualObject(parent)
+    , m_watcher(new QDBusServiceWatcher(this))
+    , m_requestTreeRegistered(false)
+    , m_sessionTreeRegistered(false)
+{
+    m_watcher->setConnection(QDBusConnection::sessionBus());
+    m_watcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+    connect(m_watcher, &QDBusServiceWatcher::serviceUnregistered, this, &HandleDispatcher::onPeerUnregistered);
+}
+
+HandleDispatcher *HandleDispatcher::instance()
+{
+    static HandleDispatcher *dispatcher = new HandleDispatcher(qApp);
+    return dispatcher;
+}
+
+bool HandleDispatcher::ensureRegistered(const QString &root, bool &registered)
+{
+    if (registered)
+        return true;
+    auto sessionBus = QDBusConnection::sessionBus();
+    registered = sessionBus.registerVirtualObject(root, this, QDBusConnection::SubPath);
+    if (!registered)
+        qCWarning(XdgDesktopDDEHandle) << "Failed to register handle dispatcher on" << root << sessionBus.lastError().message();
+    return registered;
+}
+
+bool HandleDispatcher::addRequest(const QString &path, Request *request)
+{
+    if (!isBelow(path, RequestRoot) || m_requests.contains(path)) {
+        qCWarning(XdgDesktopDDEHandle) << "Invalid or duplicated request handle" << path;
+        return false;
+    }
+    if (!ensureRegistered(RequestRoot, m_requestTreeRegistered))
+        return false;
+    m_requests.insert(path, request);
+    watch(path, handlePeer(path, RequestRoot));
+    return true;
+}
+
+void HandleDispatcher::removeRequest(const QString &path, Request *request)
+{
+    auto it = m_requests.find(path);
+    if (it == m_requests.end() || it.value() != request)
+        return;
+    m_requests.erase(it);
+    unwatch(path);
+}
+
+bool HandleDispatcher::addSession(const QString &path, Session *session, const QString &peer)
+{
+    if (!isBelow(path, SessionRoot) || m_sessions.contains(path)) {
+        qCWarning(XdgDesktopDDEHandle) << "Invalid or duplicated session handle" << path;
+        return false;
+    }
+    if (!ensureRegistered(SessionRoot, m_sessionTreeRegistered))
+        return false;
+    m_sessions.insert(path, session);
+    watch(path, handlePeer(path, SessionRoot));
+    if (!peer.isEmpty())
+        watch(path, peer);
+    return true;
+}
+
+void HandleDispatcher::removeSession(const QString &path, Session *session)
+{
+    auto it = m_sessions.find(path);
+    if (it == m_sessions.end() || it.value() != session)
+        return;
+    m_sessions.erase(it);
+    unwatch(path);
+}
+
+void HandleDispatcher::watch(const QString &path, const QString &peer)
+{
+    if (peer.isEmpty() || m_handlePeers.contains(path, peer))
+        return;
+    // One watch per peer, however many handles it has
+    if (!m_peerHandles.contains(peer))
+        m_watcher->addWatchedService(peer);
+    m_peerHandles.insert(peer, path);
+    m_handlePeers.insert(path, peer);
+}
+
+void HandleDispatcher::unwatch(const QString &path)
+{
+    const auto peers = m_handlePeers.values(path);
+    m_handlePeers.remove(path);
+    for (const QString &peer : peers) {
+        m_peerHandles.remove(peer, path);
+        if (!m_peerHandles.contains(peer))
+            m_watcher->removeWatchedService(peer);
+    }
+}
+
+void HandleDispatcher::onPeerUnregistered(const QString &peer)
+{
+    const auto paths = m_peerHandles.values(peer);
+    qCDebug(XdgDesktopDDEHandle) << peer << "left the bus, closing" << paths.size() << "handles";
+    for (const QString &path : paths) {
+        // Closing removes the handle, look it up again in case an earlier one took it along
+        if (auto request = m_requests.value(path))
+            request->close();
+        else if (auto session = m_sessions.value(path))
+            session->Close();
+    }
+}
+
+QString HandleDispatcher::introspect(const QString &path) const
+{
+    if (m_requests.contains(path)) {
+        return QStringLiteral("<interface name=\"org.freedesktop.impl.portal.Request\">"
+                              "<method name=\"Close\"/>"
+                              "</interface>");
+    }
+    if (m_sessions.contains(path)) {
+        return QStringLiteral("<interface name=\"org.freedesktop.impl.portal.Session\">"
+                              "<method name=\"Close\"/>"
+                              "<signal name=\"Closed\"/>"
+                              "<property name=\"version\" type=\"u\" access=\"read\"/>"
+                              "</interface>");
+    }
+    return QString();
+}
+
+bool HandleDispatcher::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    const QString path = message.path();
+    if (auto request = m_requests.value(path)) {
+        if (message.interface() != RequestInterface || message.member() != QLatin1String("Close"))
+            return false;
+        request->Close(message);
+        return true;
+    }
+    if (auto session = m_sessions.value(path))
+        return handleSessionMessage(session, message, connection);
+    return false;
+}
+
+bool HandleDispatcher::handleSessionMessage(Session *session, const QDBusMessage &message, const QDBusConnection &connection)
+{
+    if (message.interface() == SessionInterface && message.member() == QLatin1String("Close")) {
+        connection.send(message.createReply());
+        session->Close();
+        return true;
+    }
+    if (message.interface() != PropertiesInterface)
+        return false;
+
+    const QVariantList arguments = message.arguments();
+    if (arguments.value(0).toString() != SessionInterface) {
+        connection.send(message.createErrorReply(QDBusError::UnknownInterface, arguments.value(0).toString()));
+        return true;
+    }
+    if (message.member() == QLatin1String("Get")) {
+        if (arguments.value(1).toString() != QLatin1String("version")) {
+            connection.send(message.createErrorReply(QDBusError::UnknownProperty, arguments.value(1).toString()));
+            return true;
+        }
+        connection.send(message.createReply(QVariant::fromValue(QDBusVariant(session->version()))));
+        return true;
+    }
+    if (message.member() == QLatin1String("GetAll")) {
+        QVariantMap properties;
+        properties.insert(QStringLiteral("version"), session->version());
+        connection.send(message.createReply(properties));
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QDBusVirtualObject>
+#include <QHash>
+
+class QDBusServiceWatcher;
+class Request;
+class Session;
+
+// Serves every request and session handle from one virtual object per
+// subtree, live handles are looked up in a hash instead of each one being
+// registered in the QtDBus object tree.
+//
+// Handles are tied to the unique name of the app they were created for,
+// which is part of the handle path, and to an optional extra peer. When any
+// of them leaves the bus the handle is closed as if Close was called.
+class HandleDispatcher : public QDBusVirtualObject
+{
+    Q_OBJECT
+
+public:
+    static HandleDispatcher *instance();
+
+    // Return false if the handle is outside the served subtrees or already taken
+    bool addRequest(const QString &path, Request *request);
+    void removeRequest(const QString &path, Request *request);
+    bool addSession(const QString &path, Session *session, const QString &peer = QString());
+    void removeSession(const QString &path, Session *session);
+
+    QString introspect(const QString &path) const override;
+    bool handleMessage(const QDBusMessage &message, const QDBusConnection &connection) override;
+
+private:
+    explicit HandleDispatcher(QObject *parent = nullptr);
+
+    bool ensureRegistered(const QString &root, bool &registered);
+    bool handleSessionMessage(Session *session, const QDBusMessage &message, const QDBusConnection &connection);
+    void watch(const QString &path, const QString &peer);
+    void unwatch(const QString &path);
+    void onPeerUnregistered(const QString &peer);
+
+    QHash<QString, Request *> m_requests;
+    QHash<QString, Session *> m_sessions;
+    QDBusServiceWatcher *m_watcher;
+    QMultiHash<QString, QString> m_peerHandles; // unique name -> handle paths
+    QMultiHash<QString, QString> m_handlePeers; // handle path -> unique names
+    bool m_requestTreeRegistered;
+    bool m_sessionTreeRegistered;
+};
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "iconcache.h"
+
+#include <QApplication>
+#include <QIcon>
+#include <QTimer>
+
+#include <qpa/qplatformintegration.h>
+#include <private/qguiapplication_p.h>
+
+// About 400 app icons at 40px and a DPR of 2
+static constexpr int MaxCost = 16 * 1024;
+static constexpr char FallbackIcon[] = "application-x-executable";
+
+IconCache *IconCache::instance()
+{
+    static IconCache *cache = new IconCache(qApp);
+    return cache;
+}
+
+IconCache::IconCache(QObject *parent)
+    : QObject(parent)
+    , m_pixmaps(MaxCost)
+    , m_idleTimer(new QTimer(this))
+    , m_threaded(QGuiApplicationPrivate::platformIntegration()->hasCapability(QPlatformIntegration::ThreadedPixmaps))
+{
+    // Rasterizing, e.g. of SVG icons, is what costs, a second thread halves it
+    m_pool.setMaxThreadCount(2);
+    m_pool.setExpiryTimeout(30000);
+
+    // A zero interval timer fires once the event loop has nothing else to do
+    m_idleTimer->setInterval(0);
+    connect(m_idleTimer, &QTimer::timeout, this, &IconCache::renderNext);
+}
+
+IconCache::~IconCache()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QPixmap IconCache::pixmap(const QString &name, int size, qreal devicePixelRatio)
+{
+    const Key key { name, size, devicePixelRatio };
+    if (QPixmap *pixmap = m_pixmaps.object(key))
+        return *pixmap;
+    if (m_pending.contains(key))
+        return QPixmap();
+
+    m_pending.insert(key);
+    m_queue.append(key);
+    m_idleTimer->start();
+    return QPixmap();
+}
+
+QIcon IconCache::resolve(const QString &name)
+{
+    // fromTheme hands out icons shared through a cache, a private copy keeps
+    // other users of the icon off the engine the worker renders with.
+    // isNull() makes the engine look the icon up in the theme right here,
+    // the theme loader and its caches are not thread-safe.
+    QIcon icon = QIcon::fromTheme(name);
+    icon.detach();
+    if (icon.isNull()) {
+        icon = QIcon::fromTheme(QLatin1String(FallbackIcon));
+        icon.detach();
+        icon.isNull();
+    }
+    return icon;
+}
+
+QImage IconCache::rasterize(const QIcon &icon, const Key &key)
+{
+    const QSize size(key.size, key.size);
+    QImage image = icon.pixmap(size, key.devicePixelRatio).toImage();
+    if (image.isNull()) {
+        // Painted as a blank icon, asking the theme again would not help
+        image = QImage(size * key.devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        image.setDevicePixelRatio(key.devicePixelRatio);
+    }
+    return image;
+}
+
+void IconCache::renderNext()
+{
+    if (m_queue.isEmpty()) {
+        m_idleTimer->stop();
+        return;
+    }
+    const Key key = m_queue.takeFirst();
+    const QIcon icon = resolve(key.name);
+    if (!m_threaded) {
+        onRendered(key, rasterize(icon, key));
+        return;
+    }
+    // Only the resolved icon crosses threads, rendering it needs no theme lookup
+    m_pool.start([this, key, icon] {
+        const QImage image = rasterize(icon, key);
+        QMetaObject::invokeMethod(this, [this, key, image] {
+            onRendered(key, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void IconCache::onRendered(const Key &key, const QImage &image)
+{
+    if (!m_pending.remove(key))
+        return;
+    const int cost = qMax<qsizetype>(1, image.sizeInBytes() / 1024);
+    m_pixmaps.insert(key, new QPixmap(QPixmap::fromImage(image)), cost);
+    Q_EMIT iconReady(key.name);
+}
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QCache>
+#include <QIcon>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QThreadPool>
+
+class QTimer;
+
+// Theme icons rasterized ahead of painting, shared by all views. Icons are
+// looked up in the theme one at a time whenever the GUI thread is idle, and
+// rasterized on worker threads when the platform supports threaded pixmaps.
+class IconCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static IconCache *instance();
+    ~IconCache() override;
+
+    // Null while the icon is being rendered, iconReady follows then
+    QPixmap pixmap(const QString &name, int size, qreal devicePixelRatio);
+
+Q_SIGNALS:
+    void iconReady(const QString &name);
+
+private:
+    struct Key
+    {
+        QString name;
+        int size;
+        qreal devicePixelRatio;
+
+        inline bool operator==(const Key &other) const
+        {
+            return name == other.name && size == other.size && qFuzzyCompare(devicePixelRatio, other.devicePixelRatio);
+        }
+    };
+    friend size_t qHash(const Key &key, size_t seed)
+    {
+        return qHashMulti(seed, key.name, key.size, qRound(key.devicePixelRatio * 100));
+    }
+
+    explicit IconCache(QObject *parent = nullptr);
+
+    static QIcon resolve(const QString &name);
+    static QImage rasterize(const QIcon &icon, const Key &key);
+    void renderNext();
+    void onRendered(const Key &key, const QImage &image);
+
+    QCache<Key, QPixmap> m_pixmaps; // cost in KiB
+    QSet<Key> m_pending;
+    QList<Key> m_queue; // not looked up yet
+    QTimer *m_idleTimer;
+    QThreadPool m_pool;
+    bool m_threaded;
+};
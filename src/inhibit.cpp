@@ -9,6 +9,7 @@
 #include <QDBusMessage>
 #include <QDBusPendingCall>
 #include <QDBusPendingReply>
+#include <QPointer>
 
 #include "request.h"
 
@@ -35,26 +36,42 @@ void InhibitPortal::Inhibit(
     QString reason = options.value(QStringLiteral("reason")).toString();
     qCDebug(XdgDesktopDDEInhibit) << "reason: " << reason;
 
+    // The request exists before the reply, so a Close in between is not lost
+    auto *request = new Request(handle, QVariant(), this);
+    connect(request, &Request::closeRequested, this, &InhibitPortal::onCloseRequested);
+    const CancellationToken token = request->token();
+    QPointer<Request> guard(request);
+
     QDBusMessage message = QDBusMessage::createMethodCall(
         sessionManagerService, sessionManagerPath, sessionManagerInterface, QStringLiteral("Inhibit"));
     message << app_id << window.toUInt() << reason << flags;
 
     QDBusPendingCall pendingCall = QDBusConnection::sessionBus().asyncCall(message);
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall);
-    connect(watcher, &QDBusPendingCallWatcher::finished, [handle, this](QDBusPendingCallWatcher *watcher) {
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, token, guard](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
         QDBusPendingReply<uint> reply = *watcher;
         if (reply.isError()) {
             qCDebug(XdgDesktopDDEInhibit) << "Inhibition error: " << reply.error().message();
+            if (guard && !token.isCancelled())
+                guard->deleteLater();
             return;
         }
 
-        auto *request = new Request(handle, QVariant(reply.value()), this);
-        connect(request, &Request::closeRequested, this, &InhibitPortal::onCloseRequested);
+        if (token.isCancelled() || !guard) {
+            // Closed while the inhibition was on its way, take it back right away
+            onCloseRequested(QVariant(reply.value()));
+            return;
+        }
+        guard->setData(QVariant(reply.value()));
     });
 }
 
 void InhibitPortal::onCloseRequested(const QVariant &data)
 {
+    // No cookie yet, the pending reply releases it once it arrives
+    if (!data.isValid())
+        return;
     quint32 cookie = data.toUInt();
 
     QDBusMessage message = QDBusMessage::createMethodCall(
@@ -0,0 +1,232 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "mimehandlerindex.h"
+#include "applicationindex.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QLoggingCategory>
+#include <QMimeDatabase>
+#include <QStandardPaths>
+#include <QUrl>
+
+Q_LOGGING_CATEGORY(XdgDesktopDDEMimeIndex, "xdg-dde-mime-index")
+
+// Application ids of ApplicationManager1 are desktop file ids without suffix
+static QString appIdOf(QStringView desktopId)
+{
+    desktopId = desktopId.trimmed();
+    if (desktopId.endsWith(QLatin1String(".desktop")))
+        desktopId.chop(8);
+    return desktopId.toString();
+}
+
+static void appendUnique(QStringList &list, const QStringList &items)
+{
+    for (const QString &item : items) {
+        if (!list.contains(item))
+            list.append(item);
+    }
+}
+
+MimeHandlerIndex *MimeHandlerIndex::instance()
+{
+    static MimeHandlerIndex *index = new MimeHandlerIndex(qApp);
+    return index;
+}
+
+MimeHandlerIndex::MimeHandlerIndex(QObject *parent)
+    : QObject(parent)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_dirty(true)
+{
+    QStringList desktops;
+    for (const QString &desktop : qEnvironmentVariable("XDG_CURRENT_DESKTOP").split(QLatin1Char(':'), Qt::SkipEmptyParts))
+        desktops.append(desktop.toLower());
+
+    // Precedence of the association spec: config dirs before data dirs,
+    // desktop specific lists before the generic one
+    auto addLists = [this, &desktops](const QStringList &directories) {
+        for (const QString &directory : directories) {
+            for (const QString &desktop : std::as_const(desktops))
+                m_files.append(directory + QLatin1Char('/') + desktop + QStringLiteral("-mimeapps.list"));
+            m_files.append(directory + QStringLiteral("/mimeapps.list"));
+        }
+    };
+    const QStringList applicationDirs = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
+    addLists(QStandardPaths::standardLocations(QStandardPaths::GenericConfigLocation));
+    addLists(applicationDirs);
+    for (const QString &directory : applicationDirs)
+        m_files.append(directory + QStringLiteral("/mimeinfo.cache"));
+
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &MimeHandlerIndex::onFileChanged);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &directory) {
+        // Files are usually replaced by a rename, or created for the first time
+        for (const QString &file : std::as_const(m_files)) {
+            if (QFileInfo(file).absolutePath() == directory)
+                onFileChanged(file);
+        }
+    });
+
+    // Desktop entries contribute through their MimeType keys
+    auto index = ApplicationIndex::instance();
+    auto markDirty = [this] {
+        m_dirty = true;
+    };
+    connect(index, &ApplicationIndex::reset, this, markDirty);
+    connect(index, &ApplicationIndex::applicationAdded, this, markDirty);
+    connect(index, &ApplicationIndex::applicationChanged, this, markDirty);
+    connect(index, &ApplicationIndex::applicationRemoved, this, markDirty);
+
+    for (const QString &file : std::as_const(m_files))
+        m_parsed.insert(file, parseFile(file));
+    watch();
+}
+
+QStringList MimeHandlerIndex::handlers(const QString &contentType)
+{
+    if (contentType.isEmpty())
+        return QStringList();
+    if (m_dirty)
+        rebuild();
+
+    QMimeDatabase database;
+    const QMimeType mimeType = database.mimeTypeForName(contentType);
+    // Aliases resolve to the canonical name, parents follow the type itself
+    QStringList types{ mimeType.isValid() ? mimeType.name() : contentType };
+    if (mimeType.isValid())
+        types += mimeType.allAncestors();
+
+    QStringList handlers;
+    for (const QString &type : std::as_const(types)) {
+        appendUnique(handlers, m_merged.defaults.value(type));
+        appendUnique(handlers, m_merged.added.value(type));
+        appendUnique(handlers, m_merged.cached.value(type));
+    }
+    return handlers;
+}
+
+QString MimeHandlerIndex::contentType(const QString &contentType, const QString &uri, const QString &filename)
+{
+    if (!contentType.isEmpty())
+        return contentType;
+    QMimeDatabase database;
+    // Only names are known, the file itself may not be reachable from here
+    if (!filename.isEmpty())
+        return database.mimeTypeForFile(filename, QMimeDatabase::MatchExtension).name();
+    if (!uri.isEmpty()) {
+        const QUrl url(uri);
+        if (!url.isLocalFile())
+            return QStringLiteral("x-scheme-handler/") + url.scheme();
+        return database.mimeTypeForFile(url.toLocalFile(), QMimeDatabase::MatchExtension).name();
+    }
+    return QString();
+}
+
+void MimeHandlerIndex::watch()
+{
+    QStringList paths;
+    for (const QString &file : std::as_const(m_files)) {
+        const QFileInfo info(file);
+        if (info.exists())
+            paths.append(file);
+        if (QFileInfo::exists(info.absolutePath()))
+            paths.append(info.absolutePath());
+    }
+    paths.removeDuplicates();
+    // Watching again is a no-op for paths already watched
+    const QStringList watched = m_watcher->files() + m_watcher->directories();
+    for (const QString &path : std::as_const(watched))
+        paths.removeAll(path);
+    if (!paths.isEmpty())
+        m_watcher->addPaths(paths);
+}
+
+void MimeHandlerIndex::onFileChanged(const QString &path)
+{
+    if (!m_parsed.contains(path))
+        return;
+    qCDebug(XdgDesktopDDEMimeIndex) << "associations changed in" << path;
+    m_parsed.insert(path, parseFile(path));
+    m_dirty = true;
+    watch();
+}
+
+MimeHandlerIndex::Associations MimeHandlerIndex::parseFile(const QString &path)
+{
+    Associations associations;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return associations;
+
+    // Not QSettings, it takes '/' in keys for groups and ';' for nothing
+    QHash<QString, QStringList> *group = nullptr;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+            continue;
+        if (line.startsWith(QLatin1Char('['))) {
+            if (line == QLatin1String("[Default Applications]"))
+                group = &associations.defaults;
+            else if (line == QLatin1String("[Added Associations]"))
+                group = &associations.added;
+            else if (line == QLatin1String("[Removed Associations]"))
+                group = &associations.removed;
+            else if (line == QLatin1String("[MIME Cache]"))
+                group = &associations.cached;
+            else
+                group = nullptr;
+            continue;
+        }
+        const int separator = line.indexOf(QLatin1Char('='));
+        if (!group || separator <= 0)
+            continue;
+        QStringList appIds;
+        for (const auto &desktopId : QStringView(line).mid(separator + 1).split(QLatin1Char(';'), Qt::SkipEmptyParts))
+            appIds.append(appIdOf(desktopId));
+        (*group)[line.left(separator).trimmed()] += appIds;
+    }
+    return associations;
+}
+
+void MimeHandlerIndex::rebuild()
+{
+    m_dirty = false;
+    Associations merged;
+    for (const QString &file : std::as_const(m_files)) {
+        const Associations &associations = m_parsed[file];
+        // The most important file names the default
+        for (auto it = associations.defaults.cbegin(); it != associations.defaults.cend(); ++it) {
+            if (!merged.defaults.contains(it.key()))
+                merged.defaults.insert(it.key(), it.value());
+        }
+        for (auto it = associations.removed.cbegin(); it != associations.removed.cend(); ++it)
+            appendUnique(merged.removed[it.key()], it.value());
+        // Removals only hide associations of less important files
+        for (auto it = associations.added.cbegin(); it != associations.added.cend(); ++it) {
+            for (const QString &appId : it.value()) {
+                if (!merged.removed.value(it.key()).contains(appId))
+                    appendUnique(merged.added[it.key()], { appId });
+            }
+        }
+        for (auto it = associations.cached.cbegin(); it != associations.cached.cend(); ++it) {
+            for (const QString &appId : it.value()) {
+                if (!merged.removed.value(it.key()).contains(appId))
+                    appendUnique(merged.cached[it.key()], { appId });
+            }
+        }
+    }
+
+    const auto applications = ApplicationIndex::instance()->applications();
+    for (const auto &application : applications) {
+        for (const QString &mimeType : application.mimeTypes) {
+            if (!merged.removed.value(mimeType).contains(application.appId))
+                appendUnique(merged.cached[mimeType], { application.appId });
+        }
+    }
+    m_merged = merged;
+}
@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+class QFileSystemWatcher;
+
+// Which applications handle a MIME type, merged from mimeapps.list,
+// mimeinfo.cache and the MimeType keys of the indexed applications.
+// Each source file is parsed once and again only when it changes.
+class MimeHandlerIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    static MimeHandlerIndex *instance();
+
+    // App ids best first: defaults, added associations, then every other
+    // handler. Parent types and aliases of contentType are followed.
+    QStringList handlers(const QString &contentType);
+
+    // The MIME type of whatever the portal call names, empty if unknown
+    static QString contentType(const QString &contentType, const QString &uri, const QString &filename);
+
+private:
+    explicit MimeHandlerIndex(QObject *parent = nullptr);
+
+    // What one source file says, app ids per MIME type
+    struct Associations
+    {
+        QHash<QString, QStringList> defaults;
+        QHash<QString, QStringList> added;
+        QHash<QString, QStringList> removed;
+        QHash<QString, QStringList> cached; // mimeinfo.cache and MimeType keys
+    };
+
+    void watch();
+    void onFileChanged(const QString &path);
+    static Associations parseFile(const QString &path);
+    void rebuild();
+
+    QStringList m_files; // by precedence, most important first
+    QHash<QString, Associations> m_parsed;
+    QFileSystemWatcher *m_watcher;
+    bool m_dirty;
+    Associations m_merged;
+};
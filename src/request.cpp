@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "request.h"
+#include "handledispatcher.h"
 
 #include <QLoggingCategory>
 #include <QDBusConnection>
@@ -15,25 +16,34 @@ Request::Request(const QDBusObjectPath &handle, const QVariant &data, QObject *p
     : QObject(parent)
     , m_handle(handle)
     , m_data(data)
+    , m_registered(HandleDispatcher::instance()->addRequest(m_handle.path(), this))
 {
-    auto sessionBus = QDBusConnection::sessionBus();
-    if (!sessionBus.registerObject(m_handle.path(), this, QDBusConnection::ExportScriptableSlots)) {
-        qCDebug(XdgDesktopDDERequest) << sessionBus.lastError().message();
+    // The owner keeps using us either way, the request just can not be closed over D-Bus
+    if (!m_registered)
         qCDebug(XdgDesktopDDERequest) << "Failed to register request object for" << m_handle.path();
-        deleteLater();
-    }
 }
 
 Request::~Request()
 {
-    QDBusConnection::sessionBus().unregisterObject(m_handle.path());
+    if (m_registered)
+        HandleDispatcher::instance()->removeRequest(m_handle.path(), this);
 }
 
 void Request::Close(const QDBusMessage &message)
 {
     QDBusMessage messageReply = message.createReply();
     QDBusConnection::sessionBus().send(messageReply);
+    close();
+}
 
+void Request::close()
+{
+    if (!m_registered)
+        return;
+    // A second Close before deletion must not reach us again
+    HandleDispatcher::instance()->removeRequest(m_handle.path(), this);
+    m_registered = false;
+    m_token.cancel();
     emit closeRequested(m_data);
     deleteLater();
 }
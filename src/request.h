@@ -4,23 +4,51 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <memory>
 
 #include <QObject>
 #include <QDBusObjectPath>
 #include <QDBusError>
 
+// Set once the request it belongs to is closed. Copies share the flag and
+// outlive the request, so late results can still tell they are unwanted.
+class CancellationToken
+{
+public:
+    CancellationToken()
+        : m_flag(std::make_shared<std::atomic_bool>(false))
+    {
+    }
+
+    inline bool isCancelled() const { return m_flag->load(std::memory_order_acquire); }
+
+private:
+    friend class Request;
+    inline void cancel() { m_flag->store(true, std::memory_order_release); }
+
+    std::shared_ptr<std::atomic_bool> m_flag;
+};
+
+// Served by HandleDispatcher, only Close is exposed on the handle
 class Request : public QObject
 {
     Q_OBJECT
-    Q_CLASSINFO("D-Bus Interface", "org.freedesktop.impl.portal.Request")
 
 public:
     Request(const QDBusObjectPath &handle, const QVariant &data, QObject *parent = nullptr);
     ~Request();
 
-public slots:  // DBus methods
-    Q_SCRIPTABLE void Close(const QDBusMessage &message);
+    inline bool isValid() const { return m_registered; }
+    inline CancellationToken token() const { return m_token; }
+    inline bool isCancelled() const { return m_token.isCancelled(); }
+    // Passed along with closeRequested, e.g. a resource known only after an upstream reply
+    inline void setData(const QVariant &data) { m_data = data; }
+
+    void Close(const QDBusMessage &message);
+    // Closes the request without a caller, e.g. when the app left the bus
+    void close();
 
 signals:
     void closeRequested(const QVariant &data);
@@ -28,4 +56,6 @@ signals:
 private:
     QDBusObjectPath m_handle;
     QVariant m_data;
+    bool m_registered;
+    CancellationToken m_token;
 };
@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "screenshot.h"
+#include "dbushelpers.h"
+#include "request.h"
 
 #include <QDBusMetaType>
 #include <QDBusInterface>
@@ -15,6 +17,8 @@
 #include <QColor>
 #include <QLoggingCategory>
 
+#include <functional>
+
 Q_LOGGING_CATEGORY(XdgDesktopDDEScreenShot, "xdg-dde-screenshot")
 Q_DECLARE_METATYPE(ScreenshotPortal::ColorRGB)
 
@@ -64,6 +68,37 @@ ScreenshotPortal::ScreenshotPortal(QObject *parent)
     qCDebug(XdgDesktopDDEScreenShot) << "Screenshot and ColorPicker init";
 }
 
+// Sends the reply of the current portal call once the upstream call finished,
+// or a cancelled response as soon as the request is closed
+static void replyWhenFinished(QDBusAbstractAdaptor *portal,
+                              const QDBusObjectPath &handle,
+                              const QDBusPendingCall &upstreamCall,
+                              const std::function<uint(QDBusPendingCallWatcher *, QVariantMap &)> &handler)
+{
+    auto context = dbusContext(portal);
+    if (!context)
+        return;
+    context->setDelayedReply(true);
+    const QDBusMessage message = context->message();
+    auto request = new Request(handle, QVariant(), portal);
+    const CancellationToken token = request->token();
+    QObject::connect(request, &Request::closeRequested, portal, [message] {
+        QDBusConnection::sessionBus().send(message.createReply({ 2u, QVariantMap() }));
+    });
+
+    // Owned by the request, closing it drops the pending result along with it
+    auto watcher = new QDBusPendingCallWatcher(upstreamCall, request);
+    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, portal, [portal, message, token, request, handler](QDBusPendingCallWatcher *watcher) {
+        if (token.isCancelled())
+            return;
+        QObject::disconnect(request, nullptr, portal, nullptr);
+        request->deleteLater();
+        QVariantMap results;
+        const uint response = handler(watcher, results);
+        QDBusConnection::sessionBus().send(message.createReply({ response, results }));
+    });
+}
+
 uint ScreenshotPortal::PickColor(const QDBusObjectPath &handle,
                                  const QString &app_id,
                                  const QString &parent_window,
@@ -75,17 +110,20 @@ uint ScreenshotPortal::PickColor(const QDBusObjectPath &handle,
                                                       QStringLiteral("/ColorPicker"),
                                                       QStringLiteral("org.kde.kwin.ColorPicker"),
                                                       QStringLiteral("pick"));
-    QDBusPendingReply<QColor> pcall = QDBusConnection::sessionBus().call(msg);
-    if (pcall.isValid()) {
-        QColor selectedColor = pcall.value();
-        ColorRGB color;
-        color.red = selectedColor.redF();
-        color.green = selectedColor.greenF();
-        color.blue = selectedColor.blueF();
-        results.insert(QStringLiteral("color"), QVariant::fromValue<ScreenshotPortal::ColorRGB>(color));
-        return 0;
-    }
-    qCDebug(XdgDesktopDDEScreenShot) << "ColorPicker Failed";
+    replyWhenFinished(this, handle, QDBusConnection::sessionBus().asyncCall(msg), [](QDBusPendingCallWatcher *watcher, QVariantMap &results) -> uint {
+        QDBusPendingReply<QColor> pcall = *watcher;
+        if (pcall.isValid()) {
+            QColor selectedColor = pcall.value();
+            ScreenshotPortal::ColorRGB color;
+            color.red = selectedColor.redF();
+            color.green = selectedColor.greenF();
+            color.blue = selectedColor.blueF();
+            results.insert(QStringLiteral("color"), QVariant::fromValue<ScreenshotPortal::ColorRGB>(color));
+            return 0;
+        }
+        qCDebug(XdgDesktopDDEScreenShot) << "ColorPicker Failed";
+        return 1;
+    });
     return 1;
 }
 
@@ -101,14 +139,16 @@ uint ScreenshotPortal::Screenshot(const QDBusObjectPath &handle,
                                                       QStringLiteral("/Screenshot"),
                                                       QStringLiteral("org.kde.kwin.Screenshot"),
                                                       QStringLiteral("screenshotFullscreen"));
-    QDBusPendingReply<QString> pcall = QDBusConnection::sessionBus().call(msg);
-    pcall.waitForFinished();
-    if (pcall.isValid()) {
-        auto filepath = pcall.value();
-        qCDebug(XdgDesktopDDEScreenShot) << "Succeed" << QString("Filepath is %1").arg(filepath);
-        results.insert(QStringLiteral("uri"), QUrl::fromLocalFile(filepath).toString(QUrl::FullyEncoded));
-        return 0;
-    }
-    qCDebug(XdgDesktopDDEScreenShot) << "Screenshot Failed";
+    replyWhenFinished(this, handle, QDBusConnection::sessionBus().asyncCall(msg), [](QDBusPendingCallWatcher *watcher, QVariantMap &results) -> uint {
+        QDBusPendingReply<QString> pcall = *watcher;
+        if (pcall.isValid()) {
+            auto filepath = pcall.value();
+            qCDebug(XdgDesktopDDEScreenShot) << "Succeed" << QString("Filepath is %1").arg(filepath);
+            results.insert(QStringLiteral("uri"), QUrl::fromLocalFile(filepath).toString(QUrl::FullyEncoded));
+            return 0;
+        }
+        qCDebug(XdgDesktopDDEScreenShot) << "Screenshot Failed";
+        return 1;
+    });
     return 1;
 }
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "session.h"
+#include "handledispatcher.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(XdgDesktopDDESession, "xdg-dde-session")
+
+Session::Session(const QDBusObjectPath &handle, const QString &appId, const QString &peer, QObject *parent)
+    : QObject(parent)
+    , m_handle(handle)
+    , m_appId(appId)
+    , m_peer(peer)
+    , m_registered(HandleDispatcher::instance()->addSession(handle.path(), this, peer))
+    , m_closing(false)
+{
+    if (!m_registered) {
+        // The owner checks isValid() and deletes us, going away behind its back would leave it dangling
+        qCWarning(XdgDesktopDDESession) << "Failed to register session" << m_handle.path();
+        return;
+    }
+    SessionRegistry::instance()->add(this);
+}
+
+Session::~Session()
+{
+    // Subclasses are gone already, aboutToClose is only emitted by Close()
+    m_closing = true;
+    if (m_registered) {
+        SessionRegistry::instance()->remove(this);
+        HandleDispatcher::instance()->removeSession(m_handle.path(), this);
+    }
+}
+
+void Session::close()
+{
+    if (m_closing)
+        return;
+    if (m_registered) {
+        auto closed = QDBusMessage::createSignal(m_handle.path(), QStringLiteral("org.freedesktop.impl.portal.Session"), QStringLiteral("Closed"));
+        QDBusConnection::sessionBus().send(closed);
+    }
+    Close();
+}
+
+void Session::Close()
+{
+    if (m_closing)
+        return;
+    qCDebug(XdgDesktopDDESession) << "Close session" << m_handle.path();
+    release();
+    deleteLater();
+}
+
+void Session::release()
+{
+    if (m_closing)
+        return;
+    m_closing = true;
+    Q_EMIT aboutToClose();
+    if (m_registered) {
+        SessionRegistry::instance()->remove(this);
+        HandleDispatcher::instance()->removeSession(m_handle.path(), this);
+        m_registered = false;
+    }
+}
+
+SessionRegistry::SessionRegistry(QObject *parent)
+    : QObject(parent)
+{
+}
+
+SessionRegistry *SessionRegistry::instance()
+{
+    static SessionRegistry *registry = new SessionRegistry(qApp);
+    return registry;
+}
+
+Session *SessionRegistry::session(const QDBusObjectPath &handle) const
+{
+    return m_sessions.value(handle.path());
+}
+
+QList<Session *> SessionRegistry::sessions() const
+{
+    return m_sessions.values();
+}
+
+QList<Session *> SessionRegistry::sessions(const QString &appId) const
+{
+    QList<Session *> result;
+    for (auto session : m_sessions) {
+        if (session->appId() == appId)
+            result.append(session);
+    }
+    return result;
+}
+
+void SessionRegistry::add(Session *session)
+{
+    m_sessions.insert(session->handle().path(), session);
+}
+
+void SessionRegistry::remove(Session *session)
+{
+    m_sessions.remove(session->handle().path());
+}
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QDBusObjectPath>
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+// A long lived portal session, served on its session handle by
+// HandleDispatcher. Its children live exactly as long as the session does.
+class Session : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The session ends when the app or peer, the unique name of the caller, leaves the bus
+    Session(const QDBusObjectPath &handle, const QString &appId, const QString &peer, QObject *parent = nullptr);
+    ~Session() override;
+
+    inline uint version() const { return 1; }
+    inline bool isValid() const { return m_registered; }
+    inline QDBusObjectPath handle() const { return m_handle; }
+    inline QString appId() const { return m_appId; }
+    inline QString peer() const { return m_peer; }
+
+    // Ends the session from our side and tells the peer about it
+    void close();
+
+    // Handles Close from the peer
+    void Close();
+
+signals:
+    // Emitted once before the session goes away, whichever side ended it
+    void aboutToClose();
+
+private:
+    void release();
+
+    QDBusObjectPath m_handle;
+    QString m_appId;
+    QString m_peer;
+    bool m_registered;
+    bool m_closing;
+};
+
+// Tracks the live sessions of all portals by handle.
+class SessionRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SessionRegistry *instance();
+
+    Session *session(const QDBusObjectPath &handle) const;
+    template<typename T>
+    inline T *session(const QDBusObjectPath &handle) const
+    {
+        return qobject_cast<T *>(session(handle));
+    }
+    QList<Session *> sessions() const;
+    QList<Session *> sessions(const QString &appId) const;
+
+private:
+    explicit SessionRegistry(QObject *parent = nullptr);
+
+    friend class Session;
+    void add(Session *session);
+    void remove(Session *session);
+
+    QHash<QString, Session *> m_sessions; // by handle path
+};
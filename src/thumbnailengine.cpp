@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "thumbnailengine.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QUrl>
+
+Q_LOGGING_CATEGORY(XdgDesktopDDEThumbnail, "xdg-dde-thumbnail")
+
+// "normal" size of the thumbnail managing standard
+static constexpr int ThumbnailSize = 128;
+
+static QImage readCachedThumbnail(const QString &cacheFile, const QString &uri, qint64 mtime)
+{
+    QImageReader reader(cacheFile, "png");
+    // Only the text chunks are needed to tell whether it is stale
+    if (!reader.canRead() || reader.text(QStringLiteral("Thumb::URI")) != uri
+        || reader.text(QStringLiteral("Thumb::MTime")).toLongLong() != mtime)
+        return QImage();
+    return reader.read();
+}
+
+static void writeCachedThumbnail(const QString &cacheFile, QImage image, const QString &uri, qint64 mtime, const QSize &originalSize)
+{
+    const QString directory = QFileInfo(cacheFile).absolutePath();
+    if (!QDir().mkpath(directory))
+        return;
+    // The cache may reveal what the user looked at, keep it private
+    QFile::setPermissions(directory, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+
+    image.setText(QStringLiteral("Thumb::URI"), uri);
+    image.setText(QStringLiteral("Thumb::MTime"), QString::number(mtime));
+    image.setText(QStringLiteral("Thumb::Image::Width"), QString::number(originalSize.width()));
+    image.setText(QStringLiteral("Thumb::Image::Height"), QString::number(originalSize.height()));
+    image.setText(QStringLiteral("Software"), QStringLiteral("xdg-desktop-portal-dde"));
+
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    QImageWriter writer(&file, "png");
+    if (!writer.write(image) || !file.commit())
+        qCDebug(XdgDesktopDDEThumbnail) << "Failed to write thumbnail" << cacheFile;
+}
+
+static QImage createThumbnail(const QString &path, const std::shared_ptr<std::atomic_bool> &cancelled)
+{
+    if (cancelled->load(std::memory_order_acquire))
+        return QImage();
+
+    const QFileInfo info(path);
+    if (!info.isFile())
+        return QImage();
+    const QString uri = QUrl::fromLocalFile(info.absoluteFilePath()).toString(QUrl::FullyEncoded);
+    const qint64 mtime = info.lastModified().toSecsSinceEpoch();
+    const QString cacheFile = ThumbnailEngine::cachePath(path);
+
+    QImage image = readCachedThumbnail(cacheFile, uri, mtime);
+    if (!image.isNull())
+        return image;
+
+    QImageReader reader(path);
+    if (!reader.canRead() || cancelled->load(std::memory_order_acquire))
+        return QImage();
+    reader.setAutoTransform(true);
+    const QSize originalSize = reader.size();
+    // Let the decoder skip the detail we throw away anyway, e.g. JPEG DCT scaling
+    if (originalSize.isValid() && (originalSize.width() > ThumbnailSize || originalSize.height() > ThumbnailSize))
+        reader.setScaledSize(originalSize.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio));
+    image = reader.read();
+    if (image.isNull()) {
+        qCDebug(XdgDesktopDDEThumbnail) << "Failed to read" << path << reader.errorString();
+        return QImage();
+    }
+    // Some formats can not scale while decoding
+    if (image.width() > ThumbnailSize || image.height() > ThumbnailSize)
+        image = image.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    // Never cache thumbnails of the cache itself
+    if (!path.startsWith(QFileInfo(cacheFile).absolutePath()))
+        writeCachedThumbnail(cacheFile, image, uri, mtime, originalSize);
+    return image;
+}
+
+ThumbnailEngine::ThumbnailEngine(QObject *parent)
+    : QObject(parent)
+{
+    // Leave cores for the GUI and the file system model
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+    m_pool.setExpiryTimeout(30000);
+}
+
+ThumbnailEngine::~ThumbnailEngine()
+{
+    for (const Job &job : std::as_const(m_jobs))
+        job.cancelled->store(true, std::memory_order_release);
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ThumbnailEngine::request(const QString &path, Priority priority)
+{
+    CancelFlag cancelled;
+    auto it = m_jobs.find(path);
+    if (it != m_jobs.end()) {
+        // Queued jobs can not be reordered, a preview queues a second one
+        // ahead of it and whichever finishes first answers both
+        if (priority <= it->priority)
+            return;
+        it->priority = priority;
+        cancelled = it->cancelled;
+    } else {
+        cancelled = std::make_shared<std::atomic_bool>(false);
+        m_jobs.insert(path, { cancelled, priority });
+    }
+
+    m_pool.start([this, path, cancelled] {
+        const QImage image = createThumbnail(path, cancelled);
+        if (cancelled->load(std::memory_order_acquire))
+            return;
+        QMetaObject::invokeMethod(this, [this, path, image] {
+            onFinished(path, image);
+        }, Qt::QueuedConnection);
+    }, priority);
+}
+
+void ThumbnailEngine::cancelPrefetch(const QSet<QString> &keep)
+{
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        if (it->priority == Prefetch && !keep.contains(it.key())) {
+            it->cancelled->store(true, std::memory_order_release);
+            it = m_jobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QString ThumbnailEngine::cachePath(const QString &path)
+{
+    const QString uri = QUrl::fromLocalFile(QFileInfo(path).absoluteFilePath()).toString(QUrl::FullyEncoded);
+    const QByteArray hash = QCryptographicHash::hash(uri.toUtf8(), QCryptographicHash::Md5).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QStringLiteral("/thumbnails/normal/") + QString::fromLatin1(hash) + QStringLiteral(".png");
+}
+
+void ThumbnailEngine::onFinished(const QString &path, const QImage &image)
+{
+    if (!m_jobs.remove(path))
+        return;
+    if (!image.isNull())
+        Q_EMIT thumbnailReady(path, image);
+}
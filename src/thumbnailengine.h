@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+
+// Builds thumbnails on worker threads and shares them with other apps
+// through the freedesktop thumbnail cache (~/.cache/thumbnails/normal).
+// Images are decoded straight at thumbnail size, never at full size.
+class ThumbnailEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Prefetch = 0, // shown in a view, nobody waits for it yet
+        Visible = 1,  // asked for by the preview
+    };
+
+    explicit ThumbnailEngine(QObject *parent = nullptr);
+    ~ThumbnailEngine() override;
+
+    // thumbnailReady follows once the thumbnail is known, nothing on failure
+    void request(const QString &path, Priority priority);
+    // Cancels queued prefetch jobs for paths not in keep, e.g. after scrolling
+    void cancelPrefetch(const QSet<QString> &keep);
+
+    // The freedesktop cache file of path, whether it exists or not
+    static QString cachePath(const QString &path);
+
+Q_SIGNALS:
+    void thumbnailReady(const QString &path, const QImage &image);
+
+private:
+    using CancelFlag = std::shared_ptr<std::atomic_bool>;
+    struct Job
+    {
+        CancelFlag cancelled;
+        Priority priority;
+    };
+
+    void onFinished(const QString &path, const QImage &image);
+
+    QThreadPool m_pool;
+    QHash<QString, Job> m_jobs;
+};
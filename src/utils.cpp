@@ -4,6 +4,61 @@
 
 #include "utils.h"
 
+#include <QDBusArgument>
+#include <QFile>
+
+static QString decodeByteString(const QByteArray &bytes)
+{
+    // ay strings carry their terminating NUL over the bus
+    return QFile::decodeName(bytes.endsWith('\0') ? bytes.chopped(1) : bytes);
+}
+
+void decodeOption(const QVariant &value, bool &out)
+{
+    out = value.toBool();
+}
+
+void decodeOption(const QVariant &value, uint &out)
+{
+    out = value.toUInt();
+}
+
+void decodeOption(const QVariant &value, QString &out)
+{
+    if (value.metaType() == QMetaType::fromType<QByteArray>()) {
+        out = decodeByteString(value.toByteArray());
+        return;
+    }
+    out = value.toString();
+}
+
+void decodeOption(const QVariant &value, QStringList &out)
+{
+    out.clear();
+    if (value.metaType() == QMetaType::fromType<QDBusArgument>()) {
+        // aay arrives undemarshalled
+        const QDBusArgument argument = value.value<QDBusArgument>();
+        if (argument.currentSignature() != QLatin1String("aay"))
+            return;
+        QByteArrayList list;
+        argument >> list;
+        for (const QByteArray &bytes : std::as_const(list))
+            out.append(decodeByteString(bytes));
+        return;
+    }
+    if (value.metaType() == QMetaType::fromType<QByteArrayList>()) {
+        for (const QByteArray &bytes : value.value<QByteArrayList>())
+            out.append(decodeByteString(bytes));
+        return;
+    }
+    out = value.toStringList();
+}
+
+void decodeOption(const QVariant &value, QVariant &out)
+{
+    out = value;
+}
+
 void Utils::setParentWindow(QWidget *w, const QString &parent_window)
 {
     if (parent_window.startsWith(QLatin1String("x11:"))) {
@@ -5,14 +5,51 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <QLatin1String>
+#include <QVariantMap>
 #include <QWidget>
 #include <QWindow>
 
-#define DECLEAR_PARA_WITH_FALLBACK(para, toFun, fallback) \
-    auto para = options.value(QStringLiteral("#para"), fallback).toFun();
+#include <tuple>
 
-#define DECLEAR_PARA(para, toFun) \
-    DECLEAR_PARA_WITH_FALLBACK(para, toFun, QVariant())
+// One key of the a{sv} options of a portal method, decoded into a member
+// of the struct the method declares for its options
+template<typename Options, typename T>
+struct OptionKey
+{
+    QLatin1String name;
+    T Options::*member;
+};
+
+template<typename Options, typename T>
+constexpr OptionKey<Options, T> optionKey(const char *name, T Options::*member)
+{
+    return { QLatin1String(name), member };
+}
+
+// Converters by member type. Byte strings (ay, aay) are file system paths
+// with a terminating NUL, they decode into QString and QStringList too.
+void decodeOption(const QVariant &value, bool &out);
+void decodeOption(const QVariant &value, uint &out);
+void decodeOption(const QVariant &value, QString &out);
+void decodeOption(const QVariant &value, QStringList &out);
+// Kept as is, e.g. for structures demarshalled later
+void decodeOption(const QVariant &value, QVariant &out);
+
+// Decodes options in a single pass, keys missing from the map keep the
+// defaults of Options and unknown keys are ignored. schema is a constexpr
+// tuple of optionKey()s, matching compares against Latin-1 keys in place.
+template<typename Options, typename... Keys>
+Options decodeOptions(const QVariantMap &options, const std::tuple<Keys...> &schema)
+{
+    Options decoded;
+    for (auto it = options.cbegin(); it != options.cend(); ++it) {
+        std::apply([&decoded, &it](const auto &...key) {
+            (void)((it.key() == key.name && (decodeOption(it.value(), decoded.*(key.member)), true)) || ...);
+        }, schema);
+    }
+    return decoded;
+}
 
 class Utils : public QObject
 {
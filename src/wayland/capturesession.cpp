@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "capturesession.h"
+#include "portalwaylandcontext.h"
+
+#include <QLoggingCategory>
+
+#include <private/qwaylandscreen_p.h>
+
+Q_DECLARE_LOGGING_CATEGORY(portalWayland);
+
+CaptureBuffer::~CaptureBuffer()
+{
+    if (manager)
+        manager->releaseFrame(frame);
+}
+
+CaptureSession::CaptureSession(PortalWaylandContext *context,
+                               QtWaylandClient::QWaylandScreen *screen,
+                               const CaptureSessionKey &key,
+                               QObject *parent)
+    : QObject(parent)
+    , m_context(context)
+    , m_screen(screen)
+    , m_key(key)
+    , m_manager(std::make_shared<ScreenCopyManager>())
+    , m_refCount(0)
+{
+    // Bind now instead of on the next event loop iteration
+    m_manager->initialize();
+}
+
+CaptureSession::~CaptureSession()
+{
+    m_manager->releaseFrame(m_pendingFrame);
+}
+
+void CaptureSession::requestFrame()
+{
+    if (m_pendingFrame)
+        return;
+    if (!m_manager->isActive()) {
+        Q_EMIT frameFailed();
+        return;
+    }
+
+    // Let the compositor crop, buffers are then allocated at the region size
+    QPointer<ScreenCopyFrame> frame = m_key.region.isNull()
+            ? m_manager->captureOutput(m_key.overlayCursor, m_key.output)
+            : m_manager->captureOutputRegion(m_key.overlayCursor,
+                                             m_key.output,
+                                             m_key.region.x(),
+                                             m_key.region.y(),
+                                             m_key.region.width(),
+                                             m_key.region.height());
+    // The compositor holds the copy back until something changed
+    frame->setDamageTracking(true);
+    connect(frame, &ScreenCopyFrame::ready, this, [this, frame](QImage image) {
+        onFrameReady(frame, image);
+    });
+    connect(frame, &ScreenCopyFrame::failed, this, [this, frame] {
+        onFrameFailed(frame);
+    });
+    m_pendingFrame = frame;
+}
+
+void CaptureSession::onFrameReady(ScreenCopyFrame *frame, const QImage &image)
+{
+    m_pendingFrame.clear();
+
+    auto buffer = std::make_shared<CaptureBuffer>();
+    buffer->image = image;
+    buffer->damage = frame->damage();
+    buffer->presentationTime = frame->presentationTime();
+    buffer->frame = frame;
+    buffer->manager = m_manager;
+    // Streams may request the next frame while handling this one
+    Q_EMIT frameReady(buffer);
+}
+
+void CaptureSession::onFrameFailed(ScreenCopyFrame *frame)
+{
+    qCDebug(portalWayland) << "capture session frame failed";
+    m_pendingFrame.clear();
+    m_manager->releaseFrame(frame);
+    Q_EMIT frameFailed();
+}
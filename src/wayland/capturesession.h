@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "protocols/screencopy.h"
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPointer>
+#include <QRegion>
+
+#include <memory>
+
+namespace QtWaylandClient {
+class QWaylandScreen;
+}
+
+class PortalWaylandContext;
+
+// One captured frame. It is shared by every stream of a session and goes
+// back to the compositor once the last consumer released it.
+struct CaptureBuffer
+{
+    ~CaptureBuffer();
+
+    QImage image;
+    QRegion damage; // relative to the previous frame of the session
+    quint64 presentationTime = 0;
+    QPointer<ScreenCopyFrame> frame;
+    // Keeps the shm memory of the frame alive after the session went
+    std::shared_ptr<ScreenCopyManager> manager;
+};
+
+using CaptureBufferPtr = std::shared_ptr<const CaptureBuffer>;
+
+struct CaptureSessionKey
+{
+    ::wl_output *output = nullptr;
+    bool overlayCursor = false;
+    QRect region; // in output logical coordinates, null captures the whole output
+
+    inline bool operator==(const CaptureSessionKey &other) const
+    {
+        return output == other.output && overlayCursor == other.overlayCursor && region == other.region;
+    }
+};
+
+inline size_t qHash(const CaptureSessionKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed,
+                      key.output,
+                      key.overlayCursor,
+                      key.region.x(),
+                      key.region.y(),
+                      key.region.width(),
+                      key.region.height());
+}
+
+// Captures one source for all streams showing it, so the compositor copies
+// each frame once no matter how many consumers there are. The compositor
+// tracks damage per screencopy client, every session binds its own manager
+// so sessions of the same output do not consume each other's damage.
+class CaptureSession : public QObject
+{
+    Q_OBJECT
+public:
+    CaptureSession(PortalWaylandContext *context,
+                   QtWaylandClient::QWaylandScreen *screen,
+                   const CaptureSessionKey &key,
+                   QObject *parent = nullptr);
+    ~CaptureSession() override;
+
+    inline CaptureSessionKey key() const { return m_key; }
+    inline QtWaylandClient::QWaylandScreen *screen() const { return m_screen; }
+
+    // Starts a capture unless one is already running, its result is shared
+    void requestFrame();
+
+    inline void ref() { ++m_refCount; }
+    inline bool deref() { return --m_refCount > 0; }
+
+Q_SIGNALS:
+    void frameReady(const CaptureBufferPtr &buffer);
+    void frameFailed();
+
+private:
+    void onFrameReady(ScreenCopyFrame *frame, const QImage &image);
+    void onFrameFailed(ScreenCopyFrame *frame);
+
+    QPointer<PortalWaylandContext> m_context;
+    QtWaylandClient::QWaylandScreen *m_screen;
+    CaptureSessionKey m_key;
+    std::shared_ptr<ScreenCopyManager> m_manager;
+    QPointer<ScreenCopyFrame> m_pendingFrame;
+    int m_refCount;
+};
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "clipboardportal.h"
+#include "remotedesktopportal.h"
+#include "protocols/common.h"
+#include "protocols/datacontrol.h"
+
+#include <QLoggingCategory>
+
+#include <private/qwaylandinputdevice_p.h>
+
+#include <unistd.h>
+
+Q_DECLARE_LOGGING_CATEGORY(portalWayland);
+
+ClipboardPortalWayland::ClipboardPortalWayland(PortalWaylandContext *context)
+    : AbstractWaylandPortal(context)
+    , m_serial(0)
+{
+}
+
+ClipboardPortalWayland::~ClipboardPortalWayland()
+{
+    closeTransfers();
+}
+
+RemoteDesktopSession *ClipboardPortalWayland::clipboardSession(const QDBusObjectPath &session_handle)
+{
+    auto remoteDesktop = context() ? context()->remoteDesktopPortal() : nullptr;
+    auto session = remoteDesktop ? remoteDesktop->session(session_handle) : nullptr;
+    if (!session || !session->isClipboardEnabled()) {
+        context()->sendErrorReply(QDBusError::AccessDenied, QStringLiteral("Clipboard is not enabled for this session"));
+        return nullptr;
+    }
+    return session;
+}
+
+QPointer<DataControlDevice> ClipboardPortalWayland::device()
+{
+    if (m_device || !context())
+        return m_device;
+    auto inputDevice = waylandDisplay()->defaultInputDevice();
+    m_device = context()->dataControlManager()->device(inputDevice ? inputDevice->wl_seat() : nullptr);
+    if (m_device)
+        connect(m_device, &DataControlDevice::selectionChanged, this, &ClipboardPortalWayland::onSelectionChanged);
+    return m_device;
+}
+
+void ClipboardPortalWayland::RequestClipboard(const QDBusObjectPath &session_handle, const QVariantMap &options)
+{
+    Q_UNUSED(options)
+    auto remoteDesktop = context() ? context()->remoteDesktopPortal() : nullptr;
+    auto session = remoteDesktop ? remoteDesktop->session(session_handle) : nullptr;
+    if (!session || session->isStarted()) {
+        qCWarning(portalWayland) << "Clipboard requested for unknown or started session" << session_handle.path();
+        return;
+    }
+    session->setClipboardRequested(true);
+    // Bind the device now, so the selection is known once the session starts
+    device();
+}
+
+void ClipboardPortalWayland::SetSelection(const QDBusObjectPath &session_handle, const QVariantMap &options)
+{
+    auto session = clipboardSession(session_handle);
+    if (!session || !device())
+        return;
+    const QStringList mimeTypes = options.value(QStringLiteral("mime_types")).toStringList();
+    releaseSource();
+    if (mimeTypes.isEmpty()) {
+        m_device->setSelection(nullptr);
+        return;
+    }
+    m_source.reset(context()->dataControlManager()->createSource(mimeTypes));
+    if (!m_source)
+        return;
+    m_owner = session;
+    connect(m_source.get(), &DataControlSource::sendRequested, this, &ClipboardPortalWayland::onSendRequested);
+    connect(m_source.get(), &DataControlSource::cancelled, this, [this] {
+        releaseSource();
+        onSelectionChanged();
+    });
+    connect(session, &Session::aboutToClose, m_source.get(), [this] {
+        releaseSource();
+    });
+    m_device->setSelection(m_source.get());
+}
+
+void ClipboardPortalWayland::onSendRequested(const QString &mimeType, int fd)
+{
+    if (!m_owner) {
+        close(fd);
+        return;
+    }
+    // Handed to the session as is, it writes into the requesting client directly
+    const uint serial = ++m_serial;
+    m_transfers.insert({ m_owner->handle().path(), serial }, fd);
+    Q_EMIT SelectionTransfer(m_owner->handle(), mimeType, serial);
+}
+
+QDBusUnixFileDescriptor ClipboardPortalWayland::SelectionWrite(const QDBusObjectPath &session_handle, uint serial)
+{
+    auto session = clipboardSession(session_handle);
+    if (!session)
+        return QDBusUnixFileDescriptor();
+    const QPair<QString, uint> transfer(session_handle.path(), serial);
+    if (session != m_owner || !m_transfers.contains(transfer)) {
+        context()->sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("Unknown transfer serial"));
+        return QDBusUnixFileDescriptor();
+    }
+    QDBusUnixFileDescriptor descriptor;
+    // Ownership moves into the reply, the requester sees EOF once the session closes its copy
+    descriptor.giveFileDescriptor(m_transfers.take(transfer));
+    return descriptor;
+}
+
+void ClipboardPortalWayland::SelectionWriteDone(const QDBusObjectPath &session_handle, uint serial, bool success)
+{
+    // Only the session a transfer was announced to may end it
+    if (!clipboardSession(session_handle))
+        return;
+    const int fd = m_transfers.take({ session_handle.path(), serial });
+    if (fd > 0)
+        close(fd);
+    if (!success)
+        qCDebug(portalWayland) << "Clipboard transfer" << serial << "failed";
+}
+
+QDBusUnixFileDescriptor ClipboardPortalWayland::SelectionRead(const QDBusObjectPath &session_handle, const QString &mime_type)
+{
+    auto session = clipboardSession(session_handle);
+    if (!session)
+        return QDBusUnixFileDescriptor();
+    auto offer = device() ? m_device->selection() : nullptr;
+    const int fd = offer ? offer->receive(mime_type) : -1;
+    if (fd < 0) {
+        context()->sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("No selection for %1").arg(mime_type));
+        return QDBusUnixFileDescriptor();
+    }
+    QDBusUnixFileDescriptor descriptor;
+    descriptor.giveFileDescriptor(fd);
+    return descriptor;
+}
+
+void ClipboardPortalWayland::onSelectionChanged()
+{
+    auto remoteDesktop = context() ? context()->remoteDesktopPortal() : nullptr;
+    if (!remoteDesktop || !m_device)
+        return;
+    const auto offer = m_device->selection();
+    const QStringList mimeTypes = offer ? offer->mimeTypes() : QStringList();
+    for (auto session : remoteDesktop->sessions()) {
+        if (!session->isClipboardEnabled())
+            continue;
+        QVariantMap options;
+        options.insert(QStringLiteral("mime_types"), mimeTypes);
+        options.insert(QStringLiteral("session_is_owner"), m_source && session == m_owner);
+        Q_EMIT SelectionOwnerChanged(session->handle(), options);
+    }
+}
+
+void ClipboardPortalWayland::releaseSource()
+{
+    closeTransfers();
+    m_owner.clear();
+    // Deleting the source from its own signal is not safe
+    if (m_source)
+        m_source.release()->deleteLater();
+}
+
+void ClipboardPortalWayland::closeTransfers()
+{
+    for (int fd : std::as_const(m_transfers))
+        close(fd);
+    m_transfers.clear();
+}
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "abstractwaylandportal.h"
+
+#include <QDBusObjectPath>
+#include <QDBusUnixFileDescriptor>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+
+#include <memory>
+
+class DataControlDevice;
+class DataControlSource;
+class RemoteDesktopSession;
+
+// Clipboard of remote desktop sessions. Contents never pass through the
+// portal: readers get the pipe the selection owner writes into, and the
+// remote side writes straight into the pipe of the requesting client.
+class ClipboardPortalWayland : public AbstractWaylandPortal
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.freedesktop.impl.portal.Clipboard")
+    Q_PROPERTY(uint version READ version CONSTANT)
+
+public:
+    ClipboardPortalWayland(PortalWaylandContext *context);
+    ~ClipboardPortalWayland() override;
+
+    inline uint version() const { return 1; }
+
+public Q_SLOTS:
+    void RequestClipboard(const QDBusObjectPath &session_handle, const QVariantMap &options);
+    void SetSelection(const QDBusObjectPath &session_handle, const QVariantMap &options);
+    QDBusUnixFileDescriptor SelectionWrite(const QDBusObjectPath &session_handle, uint serial);
+    void SelectionWriteDone(const QDBusObjectPath &session_handle, uint serial, bool success);
+    QDBusUnixFileDescriptor SelectionRead(const QDBusObjectPath &session_handle, const QString &mime_type);
+
+Q_SIGNALS:
+    void SelectionOwnerChanged(const QDBusObjectPath &session_handle, const QVariantMap &options);
+    void SelectionTransfer(const QDBusObjectPath &session_handle, const QString &mime_type, uint serial);
+
+private:
+    RemoteDesktopSession *clipboardSession(const QDBusObjectPath &session_handle);
+    QPointer<DataControlDevice> device();
+    void onSelectionChanged();
+    void onSendRequested(const QString &mimeType, int fd);
+    void releaseSource();
+    void closeTransfers();
+
+    QPointer<DataControlDevice> m_device;
+    std::unique_ptr<DataControlSource> m_source;
+    QPointer<RemoteDesktopSession> m_owner;
+    // (session handle, serial) -> write end of the requesting client
+    QHash<QPair<QString, uint>, int> m_transfers;
+    uint m_serial;
+};
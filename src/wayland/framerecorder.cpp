@@ -0,0 +1,241 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "framerecorder.h"
+
+#include <QFile>
+#include <QLoggingCategory>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+Q_DECLARE_LOGGING_CATEGORY(portalWayland);
+
+// Force a full frame regularly so old records can be dropped without
+// breaking the ones after them
+static constexpr quint64 KeyframeInterval = 1000000000;
+static constexpr quint32 DumpVersion = 1;
+
+static qsizetype alignedSize(qsizetype size)
+{
+    return (size + 7) & ~qsizetype(7);
+}
+
+FrameRecorder::FrameRecorder(ScreenCastStream *stream, int seconds, qsizetype capacity, Mode mode, QObject *parent)
+    : QObject(parent)
+    , m_stream(stream)
+    , m_duration(quint64(qMax(1, seconds)) * 1000000000)
+    , m_capacity(capacity)
+    , m_mode(mode)
+    , m_fd(-1)
+    , m_data(nullptr)
+    , m_writeOffset(0)
+    , m_lastKeyframeTime(0)
+{
+    m_fd = memfd_create("xdg-desktop-portal-dde-recorder", MFD_CLOEXEC);
+    if (m_fd < 0 || ftruncate(m_fd, m_capacity) < 0) {
+        qCWarning(portalWayland) << "Failed to create recorder memory:" << strerror(errno);
+        return;
+    }
+    void *data = mmap(nullptr, m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED) {
+        qCWarning(portalWayland) << "Failed to map recorder memory:" << strerror(errno);
+        return;
+    }
+    m_data = static_cast<uchar *>(data);
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    stop();
+    if (m_data)
+        munmap(m_data, m_capacity);
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+void FrameRecorder::start()
+{
+    if (!m_stream || !isValid())
+        return;
+    connect(m_stream, &ScreenCastStream::frameReady, this, &FrameRecorder::onFrameReady, Qt::UniqueConnection);
+    // Frames are released as soon as they are copied, one buffer is enough
+    m_stream->setBufferCount(1);
+    m_stream->start();
+}
+
+void FrameRecorder::stop()
+{
+    if (!m_stream)
+        return;
+    disconnect(m_stream, &ScreenCastStream::frameReady, this, &FrameRecorder::onFrameReady);
+    m_stream->stop();
+}
+
+void FrameRecorder::clear()
+{
+    m_records.clear();
+    m_writeOffset = 0;
+}
+
+void FrameRecorder::onFrameReady(const ScreenCastFrame &frame)
+{
+    append(frame);
+    // Pixels are copied, hand the buffer back right away
+    m_stream->releaseBuffer(frame.sequence);
+}
+
+void FrameRecorder::append(const ScreenCastFrame &frame)
+{
+    const QImage &image = frame.image;
+    const qsizetype bytesPerPixel = image.depth() / 8;
+    bool keyframe = m_mode == Raw || m_records.isEmpty() || image.size() != m_frameSize
+            || frame.presentationTime - m_lastKeyframeTime >= KeyframeInterval;
+
+    QList<QRect> rects;
+    qsizetype size = 0;
+    qsizetype offset = -1;
+    while (offset < 0) {
+        rects.clear();
+        if (keyframe) {
+            rects.append(image.rect());
+        } else {
+            for (const QRect &rect : frame.damage.intersected(image.rect()))
+                rects.append(rect);
+        }
+        size = sizeof(RecordHeader) + rects.size() * 4 * sizeof(qint32);
+        for (const QRect &rect : std::as_const(rects))
+            size += rect.width() * bytesPerPixel * rect.height();
+        size = alignedSize(size);
+
+        if (size > m_capacity) {
+            qCWarning(portalWayland) << "Frame does not fit into the recorder, size:" << size;
+            return;
+        }
+        offset = reserve(size);
+        // Evicting may have taken the keyframe this delta depends on
+        if (!keyframe && m_records.isEmpty()) {
+            keyframe = true;
+            offset = -1;
+        }
+    }
+
+    uchar *data = m_data + offset;
+    RecordHeader header;
+    header.size = quint32(size);
+    header.flags = keyframe ? Keyframe : 0;
+    header.sequence = frame.sequence;
+    header.presentationTime = frame.presentationTime;
+    header.format = image.format();
+    header.width = image.width();
+    header.height = image.height();
+    header.rectCount = quint32(rects.size());
+    memcpy(data, &header, sizeof(header));
+    data += sizeof(header);
+    for (const QRect &rect : std::as_const(rects)) {
+        const qint32 geometry[4] = { rect.x(), rect.y(), rect.width(), rect.height() };
+        memcpy(data, geometry, sizeof(geometry));
+        data += sizeof(geometry);
+    }
+    for (const QRect &rect : std::as_const(rects)) {
+        const qsizetype rowSize = rect.width() * bytesPerPixel;
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            memcpy(data, image.constScanLine(y) + rect.x() * bytesPerPixel, rowSize);
+            data += rowSize;
+        }
+    }
+
+    m_records.append({ offset, size, frame.presentationTime, keyframe });
+    m_writeOffset = offset + size;
+    m_frameSize = image.size();
+    if (keyframe)
+        m_lastKeyframeTime = frame.presentationTime;
+    trimToDuration(frame.presentationTime);
+}
+
+qsizetype FrameRecorder::reserve(qsizetype size)
+{
+    qsizetype offset = m_writeOffset;
+    if (offset + size > m_capacity) {
+        // Records between the write position and the end are the oldest ones
+        while (!m_records.isEmpty() && m_records.first().offset >= offset)
+            m_records.removeFirst();
+        offset = 0;
+    }
+    while (!m_records.isEmpty()) {
+        const Record &oldest = m_records.first();
+        if (oldest.offset >= offset + size || oldest.offset + oldest.size <= offset)
+            break;
+        m_records.removeFirst();
+    }
+    // Deltas without their keyframe can not be decoded
+    while (!m_records.isEmpty() && !m_records.first().keyframe)
+        m_records.removeFirst();
+    return offset;
+}
+
+void FrameRecorder::trimToDuration(quint64 now)
+{
+    if (now < m_duration)
+        return;
+    const quint64 windowStart = now - m_duration;
+    // Drop whole keyframe groups that ended before the window started
+    while (true) {
+        qsizetype next = 1;
+        while (next < m_records.size() && !m_records.at(next).keyframe)
+            ++next;
+        if (next >= m_records.size() || m_records.at(next).presentationTime > windowStart)
+            break;
+        m_records.remove(0, next);
+    }
+}
+
+bool FrameRecorder::writeTo(QIODevice *device) const
+{
+    FileHeader header;
+    memcpy(header.magic, "DDEFRREC", sizeof(header.magic));
+    header.version = DumpVersion;
+    header.recordCount = quint32(m_records.size());
+    if (device->write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header))
+        return false;
+    for (const Record &record : m_records) {
+        if (device->write(reinterpret_cast<const char *>(m_data + record.offset), record.size) != record.size)
+            return false;
+    }
+    return true;
+}
+
+bool FrameRecorder::dump(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(portalWayland) << "Failed to open" << fileName << file.errorString();
+        return false;
+    }
+    return writeTo(&file);
+}
+
+int FrameRecorder::exportFd() const
+{
+    const int fd = memfd_create("xdg-desktop-portal-dde-recording", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        qCWarning(portalWayland) << "Failed to create recording memfd:" << strerror(errno);
+        return -1;
+    }
+    QFile file;
+    bool ok = file.open(fd, QIODevice::WriteOnly, QFileDevice::DontCloseHandle) && writeTo(&file);
+    file.close();
+    // Receivers get a read-only snapshot
+    ok = ok && fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == 0;
+    ok = ok && lseek(fd, 0, SEEK_SET) == 0;
+    if (!ok) {
+        qCWarning(portalWayland) << "Failed to export recording";
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "screencaststream.h"
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+
+class QIODevice;
+
+// Keeps the most recent frames of a stream in a memfd backed ring buffer,
+// nothing reaches the disk unless dump() or exportFd() is called.
+//
+// Dump layout: FileHeader followed by the records, oldest first. Each record
+// is a RecordHeader, its rects and then the pixel rows of every rect.
+class FrameRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    enum Mode {
+        Raw,              // every record holds the whole frame
+        DamageCompressed, // only damaged rects, with periodic keyframes
+    };
+
+    struct FileHeader
+    {
+        char magic[8]; // "DDEFRREC"
+        quint32 version;
+        quint32 recordCount;
+    };
+
+    struct RecordHeader
+    {
+        quint32 size; // including this header
+        quint32 flags;
+        quint64 sequence;
+        quint64 presentationTime;
+        quint32 format; // QImage::Format
+        qint32 width;
+        qint32 height;
+        quint32 rectCount; // followed by rectCount * 4 qint32 (x, y, width, height)
+    };
+
+    enum RecordFlag {
+        Keyframe = 0x1,
+    };
+
+    FrameRecorder(ScreenCastStream *stream, int seconds, qsizetype capacity, Mode mode = DamageCompressed, QObject *parent = nullptr);
+    ~FrameRecorder() override;
+
+    inline bool isValid() const { return m_data != nullptr; }
+    inline qsizetype frameCount() const { return m_records.size(); }
+
+    void start();
+    void stop();
+    void clear();
+    // Records one frame, start() feeds the frames of the stream through it
+    void append(const ScreenCastFrame &frame);
+
+    bool dump(const QString &fileName) const;
+    // Returns a sealed memfd holding the dump, the caller owns it. -1 on failure
+    int exportFd() const;
+
+private:
+    struct Record
+    {
+        qsizetype offset;
+        qsizetype size;
+        quint64 presentationTime;
+        bool keyframe;
+    };
+
+    void onFrameReady(const ScreenCastFrame &frame);
+    qsizetype reserve(qsizetype size);
+    void trimToDuration(quint64 now);
+    bool writeTo(QIODevice *device) const;
+
+    QPointer<ScreenCastStream> m_stream;
+    quint64 m_duration; // nanoseconds
+    qsizetype m_capacity;
+    Mode m_mode;
+    int m_fd;
+    uchar *m_data;
+    qsizetype m_writeOffset;
+    quint64 m_lastKeyframeTime;
+    QSize m_frameSize;
+    QList<Record> m_records;
+};
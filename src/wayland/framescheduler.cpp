@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "framescheduler.h"
+
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(portalWayland);
+
+static constexpr qreal DefaultFramerate = 30;
+
+FrameScheduler::FrameScheduler(QObject *parent)
+    : QObject(parent)
+    , m_maxFramerate(DefaultFramerate)
+    , m_availableBuffers(0)
+    , m_active(false)
+    , m_captureInFlight(false)
+    , m_requestTime(-1)
+    , m_lastFrameTime(-1)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &FrameScheduler::schedule);
+    m_clock.start();
+}
+
+void FrameScheduler::setMaxFramerate(qreal framerate)
+{
+    if (framerate <= 0) {
+        qCWarning(portalWayland) << "Ignore invalid max framerate" << framerate;
+        return;
+    }
+    m_maxFramerate = framerate;
+    schedule();
+}
+
+void FrameScheduler::setAvailableBuffers(int count)
+{
+    m_availableBuffers = qMax(0, count);
+    schedule();
+}
+
+void FrameScheduler::start()
+{
+    m_active = true;
+    schedule();
+}
+
+void FrameScheduler::stop()
+{
+    m_active = false;
+    m_timer.stop();
+}
+
+void FrameScheduler::bufferReleased()
+{
+    ++m_availableBuffers;
+    schedule();
+}
+
+bool FrameScheduler::frameCaptured()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const bool requested = m_captureInFlight;
+    m_captureInFlight = false;
+    if (requested)
+        updateLatency(now);
+
+    // Frames we did not ask for (pushed by the source) still honor the cap
+    const bool tooEarly = !requested && m_lastFrameTime >= 0 && now - m_lastFrameTime < frameInterval();
+    if (!m_active || m_availableBuffers <= 0 || tooEarly) {
+        ++m_statistics.droppedFrames;
+        Q_EMIT statisticsChanged();
+        schedule();
+        return false;
+    }
+
+    --m_availableBuffers;
+    m_lastFrameTime = now;
+    ++m_statistics.capturedFrames;
+    Q_EMIT statisticsChanged();
+    schedule();
+    return true;
+}
+
+void FrameScheduler::frameSkipped()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    if (m_captureInFlight)
+        updateLatency(now);
+    m_captureInFlight = false;
+    m_lastFrameTime = now;
+    ++m_statistics.skippedFrames;
+    Q_EMIT statisticsChanged();
+    schedule();
+}
+
+void FrameScheduler::frameFailed()
+{
+    m_captureInFlight = false;
+    // Retry on the next slot instead of immediately to not spin on a failing source
+    m_lastFrameTime = m_clock.nsecsElapsed();
+    schedule();
+}
+
+void FrameScheduler::schedule()
+{
+    if (!m_active || m_captureInFlight || m_availableBuffers <= 0)
+        return;
+
+    const qint64 now = m_clock.nsecsElapsed();
+    if (m_lastFrameTime >= 0) {
+        const qint64 remaining = m_lastFrameTime + frameInterval() - now;
+        if (remaining > 0) {
+            if (!m_timer.isActive())
+                m_timer.start(int((remaining + 999999) / 1000000));
+            return;
+        }
+    }
+
+    m_timer.stop();
+    m_captureInFlight = true;
+    m_requestTime = now;
+    Q_EMIT captureRequested();
+}
+
+void FrameScheduler::updateLatency(qint64 now)
+{
+    m_statistics.lastLatency = (now - m_requestTime) / 1000;
+    if (m_statistics.averageLatency == 0)
+        m_statistics.averageLatency = m_statistics.lastLatency;
+    else
+        m_statistics.averageLatency = (m_statistics.averageLatency * 7 + m_statistics.lastLatency) / 8;
+}
+
+qint64 FrameScheduler::frameInterval() const
+{
+    return qint64(1000000000 / m_maxFramerate);
+}
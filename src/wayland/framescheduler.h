@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+// Decides when a screen-cast stream may capture the next frame.
+// A capture is only requested when the consumer has a free buffer and the
+// framerate cap allows it, frames arriving without a free buffer are dropped.
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    struct Statistics {
+        quint64 capturedFrames = 0;
+        quint64 droppedFrames = 0;
+        quint64 skippedFrames = 0; // captured without damage, nothing was sent
+        qint64 lastLatency = 0;    // capture request to frame ready, in microseconds
+        qint64 averageLatency = 0; // moving average of lastLatency
+    };
+
+    explicit FrameScheduler(QObject *parent = nullptr);
+
+    void setMaxFramerate(qreal framerate);
+    inline qreal maxFramerate() const { return m_maxFramerate; }
+    void setAvailableBuffers(int count);
+    inline int availableBuffers() const { return m_availableBuffers; }
+    inline bool isActive() const { return m_active; }
+    inline Statistics statistics() const { return m_statistics; }
+
+    void start();
+    void stop();
+
+    // Consumer gave a buffer back, another frame may be captured
+    void bufferReleased();
+    // Returns false if the frame must be dropped
+    bool frameCaptured();
+    // Frame had no damage, it neither consumes a buffer nor counts as dropped
+    void frameSkipped();
+    void frameFailed();
+
+Q_SIGNALS:
+    void captureRequested();
+    void statisticsChanged();
+
+private:
+    void schedule();
+    void updateLatency(qint64 now);
+    qint64 frameInterval() const;
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qreal m_maxFramerate;
+    int m_availableBuffers;
+    bool m_active;
+    bool m_captureInFlight;
+    qint64 m_requestTime;
+    qint64 m_lastFrameTime;
+    Statistics m_statistics;
+};
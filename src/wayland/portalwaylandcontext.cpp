@@ -3,12 +3,16 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "portalwaylandcontext.h"
+#include "clipboardportal.h"
+#include "recorderportal.h"
+#include "remotedesktopportal.h"
 #include "screenshotportal.h"
 
 #include <QGuiApplication>
 #include <qpa/qplatformintegration.h>
 #include <private/qwaylandintegration_p.h>
 #include <private/qguiapplication_p.h>
+#include <private/qwaylandscreen_p.h>
 #include <QTimer>
 
 using namespace QtWaylandClient;
@@ -18,6 +22,39 @@ PortalWaylandContext::PortalWaylandContext(QObject *parent)
     , QDBusContext()
     , m_screenCopyManager(new ScreenCopyManager(this))
     , m_treelandCaptureManager(new TreeLandCaptureManager(this))
+    , m_virtualPointerManager(new VirtualPointerManager(this))
+    , m_virtualKeyboardManager(new VirtualKeyboardManager(this))
+    , m_dataControlManager(new DataControlManager(this))
+    , m_remoteDesktopPortal(new RemoteDesktopPortalWayland(this))
 {
     auto screenShotPortal = new ScreenshotPortalWayland(this);
+    auto clipboardPortal = new ClipboardPortalWayland(this);
+    if (RecorderPortalWayland::isEnabled())
+        new RecorderPortalWayland(this);
+}
+
+QPointer<CaptureSession> PortalWaylandContext::acquireCaptureSession(QtWaylandClient::QWaylandScreen *screen, bool overlayCursor, const QRect &region)
+{
+    CaptureSessionKey key;
+    key.output = screen->output();
+    key.overlayCursor = overlayCursor;
+    // A region covering the whole output is the plain output capture
+    if (region.isValid() && region != QRect(QPoint(0, 0), screen->geometry().size()))
+        key.region = region;
+
+    auto session = m_captureSessions.value(key);
+    if (!session) {
+        session = new CaptureSession(this, screen, key, this);
+        m_captureSessions.insert(key, session);
+    }
+    session->ref();
+    return session;
+}
+
+void PortalWaylandContext::releaseCaptureSession(QPointer<CaptureSession> session)
+{
+    if (!session || session->deref())
+        return;
+    m_captureSessions.remove(session->key());
+    session->deleteLater();
 }
@@ -4,12 +4,19 @@
 
 #pragma once
 
+#include "capturesession.h"
+#include "protocols/datacontrol.h"
 #include "protocols/screencopy.h"
 #include "protocols/treelandcapture.h"
+#include "protocols/virtualkeyboard.h"
+#include "protocols/virtualpointer.h"
 
 #include <QDBusContext>
+#include <QHash>
 #include <private/qwaylanddisplay_p.h>
 
+class RemoteDesktopPortalWayland;
+
 class PortalWaylandContext : public QObject, public QDBusContext
 {
     Q_OBJECT
@@ -18,8 +25,21 @@ public:
     PortalWaylandContext(QObject *parent = nullptr);
     inline QPointer<ScreenCopyManager> screenCopyManager() { return m_screenCopyManager; }
     inline QPointer<TreeLandCaptureManager> treelandCaptureManager()  { return m_treelandCaptureManager; }
+    inline QPointer<VirtualPointerManager> virtualPointerManager() { return m_virtualPointerManager; }
+    inline QPointer<VirtualKeyboardManager> virtualKeyboardManager() { return m_virtualKeyboardManager; }
+    inline QPointer<DataControlManager> dataControlManager() { return m_dataControlManager; }
+    inline QPointer<RemoteDesktopPortalWayland> remoteDesktopPortal() { return m_remoteDesktopPortal; }
+
+    // Capture sessions are shared by every stream of the same source
+    QPointer<CaptureSession> acquireCaptureSession(QtWaylandClient::QWaylandScreen *screen, bool overlayCursor, const QRect &region = QRect());
+    void releaseCaptureSession(QPointer<CaptureSession> session);
 
 private:
     ScreenCopyManager *m_screenCopyManager;
     TreeLandCaptureManager *m_treelandCaptureManager;
+    VirtualPointerManager *m_virtualPointerManager;
+    VirtualKeyboardManager *m_virtualKeyboardManager;
+    DataControlManager *m_dataControlManager;
+    RemoteDesktopPortalWayland *m_remoteDesktopPortal;
+    QHash<CaptureSessionKey, CaptureSession *> m_captureSessions;
 };
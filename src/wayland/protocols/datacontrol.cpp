@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "datacontrol.h"
+#include "common.h"
+
+#include <QLoggingCategory>
+#include <QMetaMethod>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+Q_DECLARE_LOGGING_CATEGORY(portalWaylandProtocol);
+
+DataControlOffer::DataControlOffer(struct ::zwlr_data_control_offer_v1 *object)
+    : QObject(nullptr)
+    , QtWayland::zwlr_data_control_offer_v1(object)
+{ }
+
+DataControlOffer::~DataControlOffer()
+{
+    destroy();
+}
+
+int DataControlOffer::receive(const QString &mimeType)
+{
+    if (!m_mimeTypes.contains(mimeType))
+        return -1;
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0) {
+        qCWarning(portalWaylandProtocol) << "Failed to create clipboard pipe:" << strerror(errno);
+        return -1;
+    }
+    // The selection owner writes straight into the pipe, the data never passes through us
+    QtWayland::zwlr_data_control_offer_v1::receive(mimeType, fds[1]);
+    wl_display_flush(waylandDisplay()->wl_display());
+    close(fds[1]);
+    return fds[0];
+}
+
+void DataControlOffer::zwlr_data_control_offer_v1_offer(const QString &mime_type)
+{
+    m_mimeTypes.append(mime_type);
+}
+
+DataControlSource::DataControlSource(struct ::zwlr_data_control_source_v1 *object, const QStringList &mimeTypes)
+    : QObject(nullptr)
+    , QtWayland::zwlr_data_control_source_v1(object)
+    , m_mimeTypes(mimeTypes)
+{
+    for (const QString &mimeType : m_mimeTypes)
+        offer(mimeType);
+}
+
+DataControlSource::~DataControlSource()
+{
+    destroy();
+}
+
+void DataControlSource::zwlr_data_control_source_v1_send(const QString &mime_type, int32_t fd)
+{
+    if (!isSignalConnected(QMetaMethod::fromSignal(&DataControlSource::sendRequested))) {
+        close(fd);
+        return;
+    }
+    Q_EMIT sendRequested(mime_type, fd);
+}
+
+void DataControlSource::zwlr_data_control_source_v1_cancelled()
+{
+    Q_EMIT cancelled();
+}
+
+DataControlDevice::DataControlDevice(struct ::zwlr_data_control_device_v1 *object)
+    : QObject(nullptr)
+    , QtWayland::zwlr_data_control_device_v1(object)
+    , m_selection(nullptr)
+{ }
+
+DataControlDevice::~DataControlDevice()
+{
+    qDeleteAll(m_pendingOffers);
+    delete m_selection;
+    destroy();
+}
+
+void DataControlDevice::setSelection(DataControlSource *source)
+{
+    set_selection(source ? source->object() : nullptr);
+}
+
+void DataControlDevice::zwlr_data_control_device_v1_data_offer(struct ::zwlr_data_control_offer_v1 *id)
+{
+    // Mime types follow right after, before the selection event announces the offer
+    m_pendingOffers.insert(id, new DataControlOffer(id));
+}
+
+void DataControlDevice::zwlr_data_control_device_v1_selection(struct ::zwlr_data_control_offer_v1 *id)
+{
+    delete m_selection;
+    m_selection = id ? m_pendingOffers.take(id) : nullptr;
+    Q_EMIT selectionChanged();
+}
+
+void DataControlDevice::zwlr_data_control_device_v1_finished()
+{
+    qCDebug(portalWaylandProtocol) << "data control device finished";
+    qDeleteAll(m_pendingOffers);
+    m_pendingOffers.clear();
+    delete m_selection;
+    m_selection = nullptr;
+    Q_EMIT selectionChanged();
+}
+
+DataControlManager::DataControlManager(QObject *parent)
+    : QWaylandClientExtensionTemplate<DataControlManager, destruct_data_control_manager>(1)
+    , QtWayland::zwlr_data_control_manager_v1()
+    , m_device(nullptr)
+{ }
+
+DataControlManager::~DataControlManager()
+{
+    delete m_device;
+    // Never bound on compositors without wlr-data-control
+    if (object())
+        destroy();
+}
+
+QPointer<DataControlDevice> DataControlManager::device(::wl_seat *seat)
+{
+    if (!m_device && isActive() && seat)
+        m_device = new DataControlDevice(get_data_device(seat));
+    return m_device;
+}
+
+DataControlSource *DataControlManager::createSource(const QStringList &mimeTypes)
+{
+    if (!isActive())
+        return nullptr;
+    return new DataControlSource(create_data_source(), mimeTypes);
+}
+
+void destruct_data_control_manager(DataControlManager *manager)
+{
+    Q_UNUSED(manager)
+}
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <private/qwaylandclientextension_p.h>
+#include <qwayland-wlr-data-control-unstable-v1.h>
+#include <QHash>
+#include <QStringList>
+
+class DataControlOffer : public QObject, public QtWayland::zwlr_data_control_offer_v1
+{
+    Q_OBJECT
+public:
+    explicit DataControlOffer(struct ::zwlr_data_control_offer_v1 *object);
+    ~DataControlOffer() override;
+
+    inline QStringList mimeTypes() const { return m_mimeTypes; }
+    // Returns the read end of a pipe the owner writes into, the caller owns it. -1 on failure
+    int receive(const QString &mimeType);
+
+protected:
+    void zwlr_data_control_offer_v1_offer(const QString &mime_type) override;
+
+private:
+    QStringList m_mimeTypes;
+};
+
+class DataControlSource : public QObject, public QtWayland::zwlr_data_control_source_v1
+{
+    Q_OBJECT
+public:
+    DataControlSource(struct ::zwlr_data_control_source_v1 *object, const QStringList &mimeTypes);
+    ~DataControlSource() override;
+
+    inline QStringList mimeTypes() const { return m_mimeTypes; }
+
+Q_SIGNALS:
+    // The receiver owns fd and has to close it once the data is written
+    void sendRequested(const QString &mimeType, int fd);
+    void cancelled();
+
+protected:
+    void zwlr_data_control_source_v1_send(const QString &mime_type, int32_t fd) override;
+    void zwlr_data_control_source_v1_cancelled() override;
+
+private:
+    QStringList m_mimeTypes;
+};
+
+class DataControlDevice : public QObject, public QtWayland::zwlr_data_control_device_v1
+{
+    Q_OBJECT
+public:
+    explicit DataControlDevice(struct ::zwlr_data_control_device_v1 *object);
+    ~DataControlDevice() override;
+
+    // Null when the selection is empty
+    inline DataControlOffer *selection() const { return m_selection; }
+    void setSelection(DataControlSource *source);
+
+Q_SIGNALS:
+    void selectionChanged();
+
+protected:
+    void zwlr_data_control_device_v1_data_offer(struct ::zwlr_data_control_offer_v1 *id) override;
+    void zwlr_data_control_device_v1_selection(struct ::zwlr_data_control_offer_v1 *id) override;
+    void zwlr_data_control_device_v1_finished() override;
+
+private:
+    QHash<::zwlr_data_control_offer_v1 *, DataControlOffer *> m_pendingOffers;
+    DataControlOffer *m_selection;
+};
+
+class DataControlManager;
+void destruct_data_control_manager(DataControlManager *manager);
+
+class DataControlManager : public QWaylandClientExtensionTemplate<DataControlManager, destruct_data_control_manager>,
+                           public QtWayland::zwlr_data_control_manager_v1
+{
+    Q_OBJECT
+public:
+    explicit DataControlManager(QObject *parent = nullptr);
+    ~DataControlManager() override;
+
+    // Created on first use and kept for the lifetime of the manager
+    QPointer<DataControlDevice> device(::wl_seat *seat);
+    // The caller owns the source
+    DataControlSource *createSource(const QStringList &mimeTypes);
+
+private:
+    DataControlDevice *m_device;
+};
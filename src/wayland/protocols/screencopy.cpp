@@ -8,17 +8,35 @@
 
 Q_LOGGING_CATEGORY(portalWaylandProtocol, "dde.portal.wayland.protocol");
 ScreenCopyManager::ScreenCopyManager(QObject *parent)
-    : QWaylandClientExtensionTemplate<ScreenCopyManager, destruct_screen_copy_manager>(1)
+    : QWaylandClientExtensionTemplate<ScreenCopyManager, destruct_screen_copy_manager>(2)
     , QtWayland::zwlr_screencopy_manager_v1()
 { }
 
+ScreenCopyManager::~ScreenCopyManager()
+{
+    qDeleteAll(m_screenCopyFrames);
+    m_screenCopyFrames.clear();
+    if (object())
+        destroy();
+}
+
 ScreenCopyFrame::ScreenCopyFrame(struct ::zwlr_screencopy_frame_v1 *object)
     : QObject(nullptr)
     , QtWayland::zwlr_screencopy_frame_v1(object)
     , m_shmBuffer(nullptr)
     , m_pendingShmBuffer(nullptr)
+    , m_presentationTime(0)
+    , m_damageTracking(false)
+    , m_copiedWithDamage(false)
 { }
 
+ScreenCopyFrame::~ScreenCopyFrame()
+{
+    delete m_shmBuffer;
+    delete m_pendingShmBuffer;
+    destroy();
+}
+
 QPointer<ScreenCopyFrame> ScreenCopyManager::captureOutput(int32_t overlay_cursor, struct ::wl_output *output)
 {
     auto screen_copy_frame = capture_output(overlay_cursor, output);
@@ -48,8 +66,30 @@ void ScreenCopyFrame::zwlr_screencopy_frame_v1_buffer(uint32_t format, uint32_t
     }
     if (m_pendingShmBuffer)
         return; // We only need one supported format
-    m_pendingShmBuffer = new QtWaylandClient::QWaylandShmBuffer(waylandDisplay(), QSize(width, height), QtWaylandClient::QWaylandShm::formatFrom(static_cast<::wl_shm_format>(format)));
-    copy(m_pendingShmBuffer->buffer());
+    m_bufferSize = QSize(width, height);
+    m_pendingShmBuffer = new QtWaylandClient::QWaylandShmBuffer(waylandDisplay(), m_bufferSize, QtWaylandClient::QWaylandShm::formatFrom(static_cast<::wl_shm_format>(format)));
+    m_copiedWithDamage = m_damageTracking && zwlr_screencopy_frame_v1_get_version(object()) >= 2;
+    if (m_copiedWithDamage)
+        copy_with_damage(m_pendingShmBuffer->buffer());
+    else
+        copy(m_pendingShmBuffer->buffer());
+}
+
+void ScreenCopyFrame::setDamageTracking(bool enabled)
+{
+    m_damageTracking = enabled;
+}
+
+QRegion ScreenCopyFrame::damage() const
+{
+    if (!m_copiedWithDamage)
+        return QRegion(QRect(QPoint(0, 0), m_bufferSize));
+    return m_damage;
+}
+
+void ScreenCopyFrame::zwlr_screencopy_frame_v1_damage(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    m_damage += QRect(x, y, width, height);
 }
 
 void ScreenCopyFrame::zwlr_screencopy_frame_v1_flags(uint32_t flags)
@@ -64,9 +104,7 @@ void ScreenCopyFrame::zwlr_screencopy_frame_v1_failed()
 
 void ScreenCopyFrame::zwlr_screencopy_frame_v1_ready(uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec)
 {
-    Q_UNUSED(tv_sec_hi);
-    Q_UNUSED(tv_sec_lo);
-    Q_UNUSED(tv_nsec);
+    m_presentationTime = ((quint64(tv_sec_hi) << 32 | tv_sec_lo) * 1000000000) + tv_nsec;
     if (m_shmBuffer)
         delete m_shmBuffer;
     m_shmBuffer = m_pendingShmBuffer;
@@ -74,8 +112,15 @@ void ScreenCopyFrame::zwlr_screencopy_frame_v1_ready(uint32_t tv_sec_hi, uint32_
     Q_EMIT ready(*m_shmBuffer->image());
 }
 
+void ScreenCopyManager::releaseFrame(QPointer<ScreenCopyFrame> frame)
+{
+    if (!frame)
+        return;
+    m_screenCopyFrames.removeOne(frame.data());
+    frame->deleteLater();
+}
+
 void destruct_screen_copy_manager(ScreenCopyManager *screenCopyManager)
 {
-    qDeleteAll(screenCopyManager->m_screenCopyFrames);
-    screenCopyManager->m_screenCopyFrames.clear();
+    Q_UNUSED(screenCopyManager)
 }
@@ -7,6 +7,7 @@
 #include <private/qwaylandclientextension_p.h>
 #include <qwayland-wlr-screencopy-unstable-v1.h>
 #include <QList>
+#include <QRegion>
 #include <QPointer>
 #include <private/qwaylandshmbackingstore_p.h>
 
@@ -15,7 +16,14 @@ class ScreenCopyFrame : public QObject, public QtWayland::zwlr_screencopy_frame_
     Q_OBJECT
 public:
     ScreenCopyFrame(struct ::zwlr_screencopy_frame_v1 *object);
+    ~ScreenCopyFrame() override;
     QtWayland::zwlr_screencopy_frame_v1::flags flags();
+    // Presentation time reported by the compositor, in nanoseconds
+    inline quint64 presentationTime() const { return m_presentationTime; }
+    // Wait for damage and report it, needs zwlr_screencopy_manager_v1 version 2
+    void setDamageTracking(bool enabled);
+    // Damaged buffer area, the whole buffer if the compositor can not report damage
+    QRegion damage() const;
 
 Q_SIGNALS:
     void ready(QImage image);
@@ -26,11 +34,17 @@ protected:
     void zwlr_screencopy_frame_v1_flags(uint32_t flags) override;
     void zwlr_screencopy_frame_v1_ready(uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec) override;
     void zwlr_screencopy_frame_v1_failed() override;
+    void zwlr_screencopy_frame_v1_damage(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
 
 private:
     QtWaylandClient::QWaylandShmBuffer *m_shmBuffer;
     QtWaylandClient::QWaylandShmBuffer *m_pendingShmBuffer;
     QtWayland::zwlr_screencopy_frame_v1::flags m_flags;
+    quint64 m_presentationTime;
+    QSize m_bufferSize;
+    QRegion m_damage;
+    bool m_damageTracking;
+    bool m_copiedWithDamage;
 };
 
 class ScreenCopyManager;
@@ -40,11 +54,12 @@ class ScreenCopyManager : public QWaylandClientExtensionTemplate<ScreenCopyManag
     Q_OBJECT
 public:
     ScreenCopyManager(QObject *parent = nullptr);
+    ~ScreenCopyManager() override;
 
     QPointer<ScreenCopyFrame> captureOutput(int32_t overlay_cursor, struct ::wl_output *output);
     QPointer<ScreenCopyFrame> captureOutputRegion(int32_t overlay_cursor, struct ::wl_output *output, int32_t x, int32_t y, int32_t width, int32_t height);
+    void releaseFrame(QPointer<ScreenCopyFrame> frame);
 
 private:
     QList<ScreenCopyFrame *> m_screenCopyFrames;
-    friend void destruct_screen_copy_manager(ScreenCopyManager *screenCopyManager);
 };
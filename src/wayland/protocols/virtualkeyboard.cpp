@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "virtualkeyboard.h"
+
+#include <QLoggingCategory>
+
+#include <cstring>
+
+#include <linux/input-event-codes.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+Q_DECLARE_LOGGING_CATEGORY(portalWaylandProtocol);
+
+// xkb keycodes are evdev keycodes shifted by 8
+static constexpr xkb_keycode_t EvdevOffset = 8;
+
+VirtualKeyboard::VirtualKeyboard(struct ::zwp_virtual_keyboard_v1 *object)
+    : QtWayland::zwp_virtual_keyboard_v1(object)
+    , m_context(xkb_context_new(XKB_CONTEXT_NO_FLAGS))
+    , m_keymap(nullptr)
+    , m_state(nullptr)
+{
+    if (!m_context)
+        return;
+    // Empty names pick the rules, model and layout from the environment
+    xkb_rule_names names = {};
+    m_keymap = xkb_keymap_new_from_names(m_context, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    if (!m_keymap || !uploadKeymap()) {
+        qCWarning(portalWaylandProtocol) << "Failed to set up the virtual keyboard keymap";
+        return;
+    }
+    m_state = xkb_state_new(m_keymap);
+    updateKeysyms();
+}
+
+VirtualKeyboard::~VirtualKeyboard()
+{
+    xkb_state_unref(m_state);
+    xkb_keymap_unref(m_keymap);
+    xkb_context_unref(m_context);
+    destroy();
+}
+
+bool VirtualKeyboard::uploadKeymap()
+{
+    char *keymapString = xkb_keymap_get_as_string(m_keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+    if (!keymapString)
+        return false;
+    const size_t size = strlen(keymapString) + 1;
+    const int fd = memfd_create("xdg-desktop-portal-dde-keymap", MFD_CLOEXEC);
+    bool ok = fd >= 0 && write(fd, keymapString, size) == ssize_t(size);
+    free(keymapString);
+    if (ok)
+        keymap(WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1, fd, uint32_t(size));
+    if (fd >= 0)
+        close(fd);
+    return ok;
+}
+
+void VirtualKeyboard::updateKeysyms()
+{
+    m_keysyms.clear();
+    xkb_keymap_key_for_each(
+            m_keymap,
+            [](xkb_keymap *keymap, xkb_keycode_t keycode, void *data) {
+                auto keysyms = static_cast<QHash<xkb_keysym_t, KeyLevel> *>(data);
+                // Only levels reachable with Shift, the first key producing a keysym wins
+                const xkb_level_index_t levels = qMin<xkb_level_index_t>(xkb_keymap_num_levels_for_key(keymap, keycode, 0), 2);
+                for (xkb_level_index_t level = 0; level < levels; ++level) {
+                    const xkb_keysym_t *syms = nullptr;
+                    const int count = xkb_keymap_key_get_syms_by_level(keymap, keycode, 0, level, &syms);
+                    for (int i = 0; i < count; ++i) {
+                        if (!keysyms->contains(syms[i]))
+                            keysyms->insert(syms[i], { keycode, level });
+                    }
+                }
+            },
+            &m_keysyms);
+}
+
+void VirtualKeyboard::sendKey(uint32_t time, uint32_t keycode, bool pressed)
+{
+    if (!isValid())
+        return;
+    key(time, keycode, pressed ? WL_KEYBOARD_KEY_STATE_PRESSED : WL_KEYBOARD_KEY_STATE_RELEASED);
+    const auto changed = xkb_state_update_key(m_state, keycode + EvdevOffset, pressed ? XKB_KEY_DOWN : XKB_KEY_UP);
+    if (changed == 0)
+        return;
+    modifiers(xkb_state_serialize_mods(m_state, XKB_STATE_MODS_DEPRESSED),
+              xkb_state_serialize_mods(m_state, XKB_STATE_MODS_LATCHED),
+              xkb_state_serialize_mods(m_state, XKB_STATE_MODS_LOCKED),
+              xkb_state_serialize_layout(m_state, XKB_STATE_LAYOUT_EFFECTIVE));
+}
+
+bool VirtualKeyboard::sendKeysym(uint32_t time, uint32_t keysym, bool pressed)
+{
+    if (!isValid())
+        return false;
+    const auto it = m_keysyms.constFind(keysym);
+    if (it == m_keysyms.constEnd())
+        return false;
+    const bool shifted = it->level == 1;
+    if (shifted && pressed)
+        sendKey(time, KEY_LEFTSHIFT, true);
+    sendKey(time, it->keycode - EvdevOffset, pressed);
+    if (shifted && !pressed)
+        sendKey(time, KEY_LEFTSHIFT, false);
+    return true;
+}
+
+VirtualKeyboardManager::VirtualKeyboardManager(QObject *parent)
+    : QWaylandClientExtensionTemplate<VirtualKeyboardManager, destruct_virtual_keyboard_manager>(1)
+    , QtWayland::zwp_virtual_keyboard_manager_v1()
+{ }
+
+VirtualKeyboardManager::~VirtualKeyboardManager()
+{
+    // The interface has no destructor request
+    if (object())
+        zwp_virtual_keyboard_manager_v1_destroy(object());
+}
+
+VirtualKeyboard *VirtualKeyboardManager::createKeyboard(::wl_seat *seat)
+{
+    if (!isActive())
+        return nullptr;
+    return new VirtualKeyboard(create_virtual_keyboard(seat));
+}
+
+void destruct_virtual_keyboard_manager(VirtualKeyboardManager *manager)
+{
+    Q_UNUSED(manager)
+}
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "qwayland-virtual-keyboard-unstable-v1.h"
+
+#include <private/qwaylandclientextension_p.h>
+#include <QHash>
+
+#include <xkbcommon/xkbcommon.h>
+
+// Keys are evdev keycodes. The keymap is compiled from the default rules,
+// keysyms are typed with the keycode and level it has in that keymap.
+class VirtualKeyboard : public QtWayland::zwp_virtual_keyboard_v1
+{
+public:
+    explicit VirtualKeyboard(struct ::zwp_virtual_keyboard_v1 *object);
+    ~VirtualKeyboard() override;
+
+    inline bool isValid() const { return m_state != nullptr; }
+
+    void sendKey(uint32_t time, uint32_t keycode, bool pressed);
+    // Returns false if no key of the keymap produces the keysym
+    bool sendKeysym(uint32_t time, uint32_t keysym, bool pressed);
+
+private:
+    struct KeyLevel
+    {
+        xkb_keycode_t keycode;
+        xkb_level_index_t level;
+    };
+
+    bool uploadKeymap();
+    void updateKeysyms();
+
+    xkb_context *m_context;
+    xkb_keymap *m_keymap;
+    xkb_state *m_state;
+    QHash<xkb_keysym_t, KeyLevel> m_keysyms;
+};
+
+class VirtualKeyboardManager;
+void destruct_virtual_keyboard_manager(VirtualKeyboardManager *manager);
+
+class VirtualKeyboardManager : public QWaylandClientExtensionTemplate<VirtualKeyboardManager, destruct_virtual_keyboard_manager>,
+                               public QtWayland::zwp_virtual_keyboard_manager_v1
+{
+    Q_OBJECT
+public:
+    explicit VirtualKeyboardManager(QObject *parent = nullptr);
+    ~VirtualKeyboardManager() override;
+
+    // The caller owns the keyboard, it has to go before the manager
+    VirtualKeyboard *createKeyboard(::wl_seat *seat);
+};
@@ -0,0 +1,22 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "virtualpointer.h"
+
+VirtualPointerManager::VirtualPointerManager(QObject *parent)
+    : QWaylandClientExtensionTemplate<VirtualPointerManager, destruct_virtual_pointer_manager>(1)
+    , QtWayland::zwlr_virtual_pointer_manager_v1()
+{ }
+
+VirtualPointer *VirtualPointerManager::createPointer(::wl_seat *seat)
+{
+    if (!isActive())
+        return nullptr;
+    return new VirtualPointer(create_virtual_pointer(seat));
+}
+
+void destruct_virtual_pointer_manager(VirtualPointerManager *manager)
+{
+    Q_UNUSED(manager)
+}
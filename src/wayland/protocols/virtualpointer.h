@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <private/qwaylandclientextension_p.h>
+#include <qwayland-wlr-virtual-pointer-unstable-v1.h>
+
+class VirtualPointer : public QtWayland::zwlr_virtual_pointer_v1
+{
+public:
+    explicit VirtualPointer(struct ::zwlr_virtual_pointer_v1 *object)
+        : QtWayland::zwlr_virtual_pointer_v1(object)
+    { }
+
+    ~VirtualPointer() override
+    {
+        destroy();
+    }
+};
+
+class VirtualPointerManager;
+void destruct_virtual_pointer_manager(VirtualPointerManager *manager);
+
+class VirtualPointerManager : public QWaylandClientExtensionTemplate<VirtualPointerManager, destruct_virtual_pointer_manager>,
+                              public QtWayland::zwlr_virtual_pointer_manager_v1
+{
+    Q_OBJECT
+public:
+    explicit VirtualPointerManager(QObject *parent = nullptr);
+    ~VirtualPointerManager() override
+    {
+        // Never bound on compositors without wlr-virtual-pointer
+        if (object())
+            destroy();
+    }
+
+    // The caller owns the pointer, it has to go before the manager
+    VirtualPointer *createPointer(::wl_seat *seat);
+};
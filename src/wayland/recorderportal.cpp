@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "recorderportal.h"
+#include "framerecorder.h"
+#include "protocols/common.h"
+#include "screencaststream.h"
+
+#include <QDBusError>
+#include <QLoggingCategory>
+
+#include <private/qwaylandscreen_p.h>
+
+#include <unistd.h>
+
+#include <utility>
+
+Q_DECLARE_LOGGING_CATEGORY(portalWayland);
+
+static constexpr uint MaxCapacity = 2048; // MiB
+
+// Empty picks the first output
+static QtWaylandClient::QWaylandScreen *findScreen(const QString &output)
+{
+    for (auto screen : waylandDisplay()->screens()) {
+        if (output.isEmpty() || screen->name() == output)
+            return screen;
+    }
+    return nullptr;
+}
+
+RecorderPortalWayland::RecorderPortalWayland(PortalWaylandContext *context)
+    : AbstractWaylandPortal(context)
+{
+    qCInfo(portalWayland) << "screen recorder enabled";
+}
+
+RecorderPortalWayland::~RecorderPortalWayland()
+{
+    qDeleteAll(std::exchange(m_recorders, {}));
+}
+
+bool RecorderPortalWayland::isEnabled()
+{
+    return qEnvironmentVariableIntValue("XDG_DESKTOP_PORTAL_DDE_RECORDER") == 1;
+}
+
+void RecorderPortalWayland::Start(const QString &output, int seconds, uint capacity, uint mode)
+{
+    auto screen = findScreen(output);
+    if (!screen) {
+        sendError(QDBusError::InvalidArgs, QStringLiteral("No output %1").arg(output));
+        return;
+    }
+    if (seconds <= 0 || capacity == 0 || capacity > MaxCapacity || mode > FrameRecorder::DamageCompressed) {
+        sendError(QDBusError::InvalidArgs, QStringLiteral("Invalid recording parameters"));
+        return;
+    }
+
+    const QString name = screen->name();
+    delete m_recorders.take(name);
+    auto stream = new ScreenCastStream(context(), screen);
+    auto recorder = new FrameRecorder(stream, seconds, qsizetype(capacity) << 20, FrameRecorder::Mode(mode), this);
+    // The recorder stops the stream on destruction, the stream goes with it
+    stream->setParent(recorder);
+    if (!recorder->isValid()) {
+        delete recorder;
+        sendError(QDBusError::NoMemory, QStringLiteral("Failed to allocate the recording buffer"));
+        return;
+    }
+    recorder->start();
+    m_recorders.insert(name, recorder);
+    qCDebug(portalWayland) << "recording" << name << "for" << seconds << "s in" << capacity << "MiB";
+}
+
+void RecorderPortalWayland::Stop(const QString &output)
+{
+    if (auto recorder = this->recorder(output)) {
+        m_recorders.remove(m_recorders.key(recorder));
+        delete recorder;
+    }
+}
+
+QDBusUnixFileDescriptor RecorderPortalWayland::Export(const QString &output)
+{
+    auto recorder = this->recorder(output);
+    if (!recorder)
+        return QDBusUnixFileDescriptor();
+    const int fd = recorder->exportFd();
+    if (fd < 0) {
+        sendError(QDBusError::Failed, QStringLiteral("Failed to export the recording"));
+        return QDBusUnixFileDescriptor();
+    }
+    // The descriptor duplicates it
+    QDBusUnixFileDescriptor result(fd);
+    close(fd);
+    return result;
+}
+
+FrameRecorder *RecorderPortalWayland::recorder(const QString &output)
+{
+    auto screen = findScreen(output);
+    auto recorder = screen ? m_recorders.value(screen->name()) : nullptr;
+    if (!recorder)
+        sendError(QDBusError::InvalidArgs, QStringLiteral("Output %1 is not recorded").arg(output));
+    return recorder;
+}
+
+void RecorderPortalWayland::sendError(QDBusError::ErrorType type, const QString &message)
+{
+    qCWarning(portalWayland) << "recorder:" << message;
+    if (context() && context()->calledFromDBus())
+        context()->sendErrorReply(type, message);
+}
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "abstractwaylandportal.h"
+
+#include <QDBusError>
+#include <QDBusUnixFileDescriptor>
+#include <QHash>
+#include <QObject>
+
+class FrameRecorder;
+
+// Flight recorder for automated UI tests: keeps the last seconds of an
+// output in memory and hands them out once a test failed. Screen contents
+// leave the portal without asking anybody, so it is only served when the
+// portal runs with XDG_DESKTOP_PORTAL_DDE_RECORDER=1.
+class RecorderPortalWayland : public AbstractWaylandPortal
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.deepin.dde.portal.Recorder")
+
+public:
+    explicit RecorderPortalWayland(PortalWaylandContext *context);
+    ~RecorderPortalWayland() override;
+
+    static bool isEnabled();
+
+public Q_SLOTS:
+    // output is a screen name, empty records the first one. capacity is in MiB,
+    // mode a FrameRecorder::Mode. Starting a running output starts it over.
+    void Start(const QString &output, int seconds, uint capacity, uint mode);
+    void Stop(const QString &output);
+    // A sealed memfd holding the recording in the FrameRecorder dump layout.
+    // There is no call writing to a path, the caller decides where it goes.
+    QDBusUnixFileDescriptor Export(const QString &output);
+
+private:
+    // Replies with an error when output is not recorded
+    FrameRecorder *recorder(const QString &output);
+    void sendError(QDBusError::ErrorType type, const QString &message);
+
+    QHash<QString, FrameRecorder *> m_recorders; // by screen name
+};
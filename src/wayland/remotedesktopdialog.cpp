@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "remotedesktopdialog.h"
+#include "remotedesktopportal.h"
+
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+RemoteDesktopDialog::RemoteDesktopDialog(const QString &appId, uint deviceTypes, bool clipboard, QWidget *parent)
+    : QDialog(parent)
+    , m_keyboard(new QCheckBox(tr("Keyboard"), this))
+    , m_pointer(new QCheckBox(tr("Pointer"), this))
+    , m_clipboard(new QCheckBox(tr("Clipboard"), this))
+{
+    setWindowTitle(tr("Remote Desktop"));
+
+    const QString app = appId.isEmpty() ? tr("An application") : appId;
+    auto label = new QLabel(tr("%1 wants to control this desktop. Allow it to use:").arg(app), this);
+    label->setWordWrap(true);
+
+    auto buttons = new QDialogButtonBox(this);
+    buttons->addButton(tr("Deny"), QDialogButtonBox::RejectRole);
+    m_allowButton = buttons->addButton(tr("Allow"), QDialogButtonBox::AcceptRole);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(label);
+    const std::initializer_list<std::pair<QCheckBox *, bool>> options = {
+        { m_keyboard, deviceTypes & RemoteDesktopSession::Keyboard },
+        { m_pointer, deviceTypes & RemoteDesktopSession::Pointer },
+        { m_clipboard, clipboard },
+    };
+    for (const auto &[checkBox, requested] : options) {
+        // Nothing is granted that was not asked for
+        checkBox->setVisible(requested);
+        checkBox->setChecked(requested);
+        connect(checkBox, &QCheckBox::toggled, this, &RemoteDesktopDialog::updateAllowButton);
+        layout->addWidget(checkBox);
+    }
+    layout->addWidget(buttons);
+    updateAllowButton();
+}
+
+uint RemoteDesktopDialog::grantedDevices() const
+{
+    return (m_keyboard->isChecked() ? RemoteDesktopSession::Keyboard : 0)
+            | (m_pointer->isChecked() ? RemoteDesktopSession::Pointer : 0);
+}
+
+bool RemoteDesktopDialog::isClipboardGranted() const
+{
+    return m_clipboard->isChecked();
+}
+
+void RemoteDesktopDialog::updateAllowButton()
+{
+    // A session without devices is useless, deny it instead
+    m_allowButton->setEnabled(grantedDevices() != 0);
+}
@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QDialog>
+
+class QCheckBox;
+class QPushButton;
+
+// Asks the user before an app may control the session. Every requested
+// device can be granted on its own, only the checked ones are created.
+class RemoteDesktopDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    RemoteDesktopDialog(const QString &appId, uint deviceTypes, bool clipboard, QWidget *parent = nullptr);
+
+    uint grantedDevices() const;
+    bool isClipboardGranted() const;
+
+private:
+    void updateAllowButton();
+
+    QCheckBox *m_keyboard;
+    QCheckBox *m_pointer;
+    QCheckBox *m_clipboard;
+    QPushButton *m_allowButton;
+};
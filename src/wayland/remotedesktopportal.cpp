@@ -0,0 +1,398 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "remotedesktopportal.h"
+#include "dialogreply.h"
+#include "remotedesktopdialog.h"
+#include "utils.h"
+#include "protocols/common.h"
+#include "protocols/virtualkeyboard.h"
+#include "protocols/virtualpointer.h"
+
+#include <QGuiApplication>
+#include <QLoggingCategory>
+#include <QScreen>
+
+#include <private/qwaylandinputdevice_p.h>
+#include <private/qwaylandscreen_p.h>
+
+Q_DECLARE_LOGGING_CATEGORY(portalWayland);
+
+// Pointer axis value of one wheel step, as libinput reports it
+static constexpr double WheelStepDistance = 15.0;
+
+static uint32_t frameInterval()
+{
+    const QScreen *screen = QGuiApplication::primaryScreen();
+    const qreal refreshRate = screen ? screen->refreshRate() : 60;
+    return uint32_t(qMax<qreal>(1, 1000 / qMax<qreal>(1, refreshRate)));
+}
+
+RemoteDesktopSession::RemoteDesktopSession(PortalWaylandContext *context,
+                                           const QDBusObjectPath &handle,
+                                           const QString &appId,
+                                           const QString &peer,
+                                           QObject *parent)
+    : Session(handle, appId, peer, parent)
+    , m_context(context)
+    , m_started(false)
+    , m_deviceTypes(Keyboard | Pointer)
+    , m_clipboardRequested(false)
+    , m_clipboardEnabled(false)
+    , m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_flushTimer, &QTimer::timeout, this, &RemoteDesktopSession::flush);
+    m_clock.start();
+}
+
+RemoteDesktopSession::~RemoteDesktopSession()
+{
+    // Pending input still reaches the compositor before the devices go away
+    flush();
+}
+
+uint RemoteDesktopSession::start()
+{
+    if (m_started || !m_context)
+        return m_deviceTypes;
+    auto device = waylandDisplay()->defaultInputDevice();
+    ::wl_seat *seat = device ? device->wl_seat() : nullptr;
+    if (!seat) {
+        qCWarning(portalWayland) << "No seat for remote desktop input";
+        return 0;
+    }
+    if (m_deviceTypes & Pointer)
+        m_pointer.reset(m_context->virtualPointerManager()->createPointer(seat));
+    if (m_deviceTypes & Keyboard) {
+        m_keyboard.reset(m_context->virtualKeyboardManager()->createKeyboard(seat));
+        if (m_keyboard && !m_keyboard->isValid())
+            m_keyboard.reset();
+    }
+    m_deviceTypes = (m_pointer ? Pointer : 0) | (m_keyboard ? Keyboard : 0);
+    m_clipboardEnabled = m_clipboardRequested && m_context->dataControlManager()->isActive();
+    m_started = true;
+    return m_deviceTypes;
+}
+
+void RemoteDesktopSession::pointerMotion(double dx, double dy)
+{
+    InputEvent event{ InputEvent::Motion };
+    event.x = dx;
+    event.y = dy;
+    enqueue(event);
+}
+
+void RemoteDesktopSession::pointerMotionAbsolute(double x, double y)
+{
+    InputEvent event{ InputEvent::MotionAbsolute };
+    event.x = x;
+    event.y = y;
+    enqueue(event);
+}
+
+void RemoteDesktopSession::pointerButton(int button, bool pressed)
+{
+    InputEvent event{ InputEvent::Button };
+    event.code = uint32_t(button);
+    event.value = pressed;
+    enqueue(event);
+}
+
+void RemoteDesktopSession::pointerAxis(double dx, double dy, bool finish)
+{
+    InputEvent event{ InputEvent::Axis };
+    event.x = dx;
+    event.y = dy;
+    event.finish = finish;
+    enqueue(event);
+}
+
+void RemoteDesktopSession::pointerAxisDiscrete(uint axis, int steps)
+{
+    InputEvent event{ InputEvent::AxisDiscrete };
+    event.code = axis;
+    event.value = steps;
+    enqueue(event);
+}
+
+void RemoteDesktopSession::keyboardKeycode(int keycode, bool pressed)
+{
+    InputEvent event{ InputEvent::Key };
+    event.code = uint32_t(keycode);
+    event.value = pressed;
+    enqueue(event);
+}
+
+void RemoteDesktopSession::keyboardKeysym(int keysym, bool pressed)
+{
+    InputEvent event{ InputEvent::Keysym };
+    event.code = uint32_t(keysym);
+    event.value = pressed;
+    enqueue(event);
+}
+
+void RemoteDesktopSession::enqueue(const InputEvent &event)
+{
+    // Only merge with the newest event, so the order of presses and motions is kept
+    if (!m_events.isEmpty()) {
+        InputEvent &last = m_events.last();
+        if (last.type == event.type) {
+            switch (event.type) {
+            case InputEvent::Motion:
+                last.x += event.x;
+                last.y += event.y;
+                return;
+            case InputEvent::MotionAbsolute:
+                last.x = event.x;
+                last.y = event.y;
+                return;
+            case InputEvent::Axis:
+                if (last.finish)
+                    break;
+                last.x += event.x;
+                last.y += event.y;
+                last.finish = event.finish;
+                return;
+            case InputEvent::AxisDiscrete:
+                if (last.code != event.code)
+                    break;
+                last.value += event.value;
+                return;
+            default:
+                break;
+            }
+        }
+    }
+    m_events.append(event);
+    if (!m_flushTimer->isActive())
+        m_flushTimer->start(frameInterval());
+}
+
+void RemoteDesktopSession::flush()
+{
+    m_flushTimer->stop();
+    if (m_events.isEmpty())
+        return;
+    const uint32_t time = uint32_t(m_clock.elapsed());
+    for (const InputEvent &event : std::as_const(m_events)) {
+        switch (event.type) {
+        case InputEvent::Key:
+            if (m_keyboard)
+                m_keyboard->sendKey(time, event.code, event.value);
+            break;
+        case InputEvent::Keysym:
+            if (m_keyboard && !m_keyboard->sendKeysym(time, event.code, event.value))
+                qCDebug(portalWayland) << "No key in the keymap produces keysym" << Qt::hex << event.code;
+            break;
+        default:
+            sendPointerEvent(event, time);
+            break;
+        }
+    }
+    m_events.clear();
+    // Everything queued in this frame goes out together
+    if (auto display = waylandDisplay())
+        wl_display_flush(display->wl_display());
+}
+
+void RemoteDesktopSession::sendPointerEvent(const InputEvent &event, uint32_t time)
+{
+    if (!m_pointer)
+        return;
+    switch (event.type) {
+    case InputEvent::Motion:
+        m_pointer->motion(time, wl_fixed_from_double(event.x), wl_fixed_from_double(event.y));
+        break;
+    case InputEvent::MotionAbsolute: {
+        // Positions are global logical coordinates, the extent is the whole layout
+        QRect layout;
+        for (auto screen : waylandDisplay()->screens())
+            layout |= screen->geometry();
+        if (layout.isEmpty())
+            return;
+        const int x = qBound(0, qRound(event.x) - layout.x(), layout.width() - 1);
+        const int y = qBound(0, qRound(event.y) - layout.y(), layout.height() - 1);
+        m_pointer->motion_absolute(time, uint32_t(x), uint32_t(y), uint32_t(layout.width()), uint32_t(layout.height()));
+        break;
+    }
+    case InputEvent::Button:
+        m_pointer->button(time, event.code, event.value ? WL_POINTER_BUTTON_STATE_PRESSED : WL_POINTER_BUTTON_STATE_RELEASED);
+        break;
+    case InputEvent::Axis:
+        m_pointer->axis_source(WL_POINTER_AXIS_SOURCE_FINGER);
+        if (event.x != 0)
+            m_pointer->axis(time, WL_POINTER_AXIS_HORIZONTAL_SCROLL, wl_fixed_from_double(event.x));
+        if (event.y != 0)
+            m_pointer->axis(time, WL_POINTER_AXIS_VERTICAL_SCROLL, wl_fixed_from_double(event.y));
+        if (event.finish) {
+            m_pointer->axis_stop(time, WL_POINTER_AXIS_HORIZONTAL_SCROLL);
+            m_pointer->axis_stop(time, WL_POINTER_AXIS_VERTICAL_SCROLL);
+        }
+        break;
+    case InputEvent::AxisDiscrete:
+        m_pointer->axis_source(WL_POINTER_AXIS_SOURCE_WHEEL);
+        m_pointer->axis_discrete(time, event.code, wl_fixed_from_double(event.value * WheelStepDistance), event.value);
+        break;
+    default:
+        return;
+    }
+    m_pointer->frame();
+}
+
+RemoteDesktopPortalWayland::RemoteDesktopPortalWayland(PortalWaylandContext *context)
+    : AbstractWaylandPortal(context)
+{
+}
+
+uint RemoteDesktopPortalWayland::availableDeviceTypes() const
+{
+    // Touch has no virtual device protocol yet
+    return RemoteDesktopSession::Keyboard | RemoteDesktopSession::Pointer;
+}
+
+uint RemoteDesktopPortalWayland::CreateSession(const QDBusObjectPath &handle,
+                                               const QDBusObjectPath &session_handle,
+                                               const QString &app_id,
+                                               const QVariantMap &options,
+                                               QVariantMap &results)
+{
+    Q_UNUSED(handle)
+    Q_UNUSED(options)
+    Q_UNUSED(results)
+    auto session = new RemoteDesktopSession(context(), session_handle, app_id, context()->message().service(), this);
+    if (!session->isValid()) {
+        delete session;
+        return 2;
+    }
+    return 0;
+}
+
+uint RemoteDesktopPortalWayland::SelectDevices(const QDBusObjectPath &handle,
+                                               const QDBusObjectPath &session_handle,
+                                               const QString &app_id,
+                                               const QVariantMap &options,
+                                               QVariantMap &results)
+{
+    Q_UNUSED(handle)
+    Q_UNUSED(app_id)
+    Q_UNUSED(results)
+    auto session = SessionRegistry::instance()->session<RemoteDesktopSession>(session_handle);
+    if (!session || session->isStarted())
+        return 2;
+    const uint types = options.value(QStringLiteral("types"), availableDeviceTypes()).toUInt();
+    session->setDeviceTypes(types & availableDeviceTypes());
+    return 0;
+}
+
+uint RemoteDesktopPortalWayland::Start(const QDBusObjectPath &handle,
+                                       const QDBusObjectPath &session_handle,
+                                       const QString &app_id,
+                                       const QString &parent_window,
+                                       const QVariantMap &options,
+                                       QVariantMap &results)
+{
+    Q_UNUSED(options)
+    Q_UNUSED(results)
+    auto session = SessionRegistry::instance()->session<RemoteDesktopSession>(session_handle);
+    if (!session || session->isStarted())
+        return 2;
+
+    // Input injection needs the user's consent, the devices are only created once given
+    auto dialog = new RemoteDesktopDialog(app_id, session->deviceTypes(), session->isClipboardRequested());
+    Utils::setParentWindow(dialog, parent_window);
+    connect(session, &Session::aboutToClose, dialog, &QDialog::reject);
+    QPointer<RemoteDesktopSession> guard(session);
+    DialogReply::show(this, handle, dialog, true, [dialog, guard](int result, QVariantMap &results) -> uint {
+        if (result != QDialog::Accepted)
+            return 1;
+        if (!guard)
+            return 2;
+        guard->setDeviceTypes(dialog->grantedDevices());
+        guard->setClipboardRequested(dialog->isClipboardGranted());
+        const uint devices = guard->start();
+        if (devices == 0)
+            return 2;
+        results.insert(QStringLiteral("devices"), devices);
+        results.insert(QStringLiteral("clipboard_enabled"), guard->isClipboardEnabled());
+        return 0;
+    });
+    return 0;
+}
+
+RemoteDesktopSession *RemoteDesktopPortalWayland::session(const QDBusObjectPath &session_handle) const
+{
+    return SessionRegistry::instance()->session<RemoteDesktopSession>(session_handle);
+}
+
+QList<RemoteDesktopSession *> RemoteDesktopPortalWayland::sessions() const
+{
+    QList<RemoteDesktopSession *> result;
+    for (auto session : SessionRegistry::instance()->sessions()) {
+        if (auto remoteDesktopSession = qobject_cast<RemoteDesktopSession *>(session))
+            result.append(remoteDesktopSession);
+    }
+    return result;
+}
+
+RemoteDesktopSession *RemoteDesktopPortalWayland::startedSession(const QDBusObjectPath &session_handle) const
+{
+    auto session = SessionRegistry::instance()->session<RemoteDesktopSession>(session_handle);
+    if (!session || !session->isStarted()) {
+        qCWarning(portalWayland) << "Input for remote desktop session which is not started:" << session_handle.path();
+        return nullptr;
+    }
+    return session;
+}
+
+void RemoteDesktopPortalWayland::NotifyPointerMotion(const QDBusObjectPath &session_handle, const QVariantMap &options, double dx, double dy)
+{
+    Q_UNUSED(options)
+    if (auto session = startedSession(session_handle))
+        session->pointerMotion(dx, dy);
+}
+
+void RemoteDesktopPortalWayland::NotifyPointerMotionAbsolute(const QDBusObjectPath &session_handle, const QVariantMap &options, uint stream, double x, double y)
+{
+    Q_UNUSED(options)
+    // No screen cast streams are published, coordinates are taken as global
+    Q_UNUSED(stream)
+    if (auto session = startedSession(session_handle))
+        session->pointerMotionAbsolute(x, y);
+}
+
+void RemoteDesktopPortalWayland::NotifyPointerButton(const QDBusObjectPath &session_handle, const QVariantMap &options, int button, uint state)
+{
+    Q_UNUSED(options)
+    if (auto session = startedSession(session_handle))
+        session->pointerButton(button, state != 0);
+}
+
+void RemoteDesktopPortalWayland::NotifyPointerAxis(const QDBusObjectPath &session_handle, const QVariantMap &options, double dx, double dy)
+{
+    if (auto session = startedSession(session_handle))
+        session->pointerAxis(dx, dy, options.value(QStringLiteral("finish")).toBool());
+}
+
+void RemoteDesktopPortalWayland::NotifyPointerAxisDiscrete(const QDBusObjectPath &session_handle, const QVariantMap &options, uint axis, int steps)
+{
+    Q_UNUSED(options)
+    if (auto session = startedSession(session_handle))
+        session->pointerAxisDiscrete(axis, steps);
+}
+
+void RemoteDesktopPortalWayland::NotifyKeyboardKeycode(const QDBusObjectPath &session_handle, const QVariantMap &options, int keycode, uint state)
+{
+    Q_UNUSED(options)
+    if (auto session = startedSession(session_handle))
+        session->keyboardKeycode(keycode, state != 0);
+}
+
+void RemoteDesktopPortalWayland::NotifyKeyboardKeysym(const QDBusObjectPath &session_handle, const QVariantMap &options, int keysym, uint state)
+{
+    Q_UNUSED(options)
+    if (auto session = startedSession(session_handle))
+        session->keyboardKeysym(keysym, state != 0);
+}
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "abstractwaylandportal.h"
+#include "session.h"
+
+#include <QDBusObjectPath>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+#include <memory>
+
+class VirtualKeyboard;
+class VirtualPointer;
+
+// Injected input is queued and sent once per compositor frame: motions and
+// scrolls arriving in the same frame are merged, and all requests go out in
+// a single display flush.
+class RemoteDesktopSession : public Session
+{
+    Q_OBJECT
+
+public:
+    enum DeviceType {
+        Keyboard = 1,
+        Pointer = 2,
+    };
+
+    RemoteDesktopSession(PortalWaylandContext *context,
+                         const QDBusObjectPath &handle,
+                         const QString &appId,
+                         const QString &peer,
+                         QObject *parent = nullptr);
+    ~RemoteDesktopSession() override;
+
+    inline bool isStarted() const { return m_started; }
+    inline uint deviceTypes() const { return m_deviceTypes; }
+    inline void setDeviceTypes(uint types) { m_deviceTypes = types; }
+    inline void setClipboardRequested(bool requested) { m_clipboardRequested = requested; }
+    inline bool isClipboardRequested() const { return m_clipboardRequested; }
+    inline bool isClipboardEnabled() const { return m_clipboardEnabled; }
+
+    // Creates the virtual devices, returns the device types actually granted
+    uint start();
+
+    void pointerMotion(double dx, double dy);
+    void pointerMotionAbsolute(double x, double y);
+    void pointerButton(int button, bool pressed);
+    void pointerAxis(double dx, double dy, bool finish);
+    void pointerAxisDiscrete(uint axis, int steps);
+    void keyboardKeycode(int keycode, bool pressed);
+    void keyboardKeysym(int keysym, bool pressed);
+
+private:
+    struct InputEvent
+    {
+        enum Type {
+            Motion,
+            MotionAbsolute,
+            Button,
+            Axis,
+            AxisDiscrete,
+            Key,
+            Keysym,
+        };
+
+        Type type;
+        double x = 0;
+        double y = 0;
+        uint32_t code = 0; // button, axis, keycode or keysym
+        int32_t value = 0; // pressed state or discrete steps
+        bool finish = false;
+    };
+
+    void enqueue(const InputEvent &event);
+    void flush();
+    void sendPointerEvent(const InputEvent &event, uint32_t time);
+
+    QPointer<PortalWaylandContext> m_context;
+    bool m_started;
+    uint m_deviceTypes;
+    bool m_clipboardRequested;
+    bool m_clipboardEnabled;
+    std::unique_ptr<VirtualPointer> m_pointer;
+    std::unique_ptr<VirtualKeyboard> m_keyboard;
+    QList<InputEvent> m_events;
+    QTimer *m_flushTimer;
+    QElapsedTimer m_clock;
+};
+
+class RemoteDesktopPortalWayland : public AbstractWaylandPortal
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.freedesktop.impl.portal.RemoteDesktop")
+    Q_PROPERTY(uint AvailableDeviceTypes READ availableDeviceTypes CONSTANT)
+    Q_PROPERTY(uint version READ version CONSTANT)
+
+public:
+    RemoteDesktopPortalWayland(PortalWaylandContext *context);
+
+    uint availableDeviceTypes() const;
+    inline uint version() const { return 2; }
+
+    RemoteDesktopSession *session(const QDBusObjectPath &session_handle) const;
+    QList<RemoteDesktopSession *> sessions() const;
+
+public Q_SLOTS:
+    uint CreateSession(const QDBusObjectPath &handle,
+                       const QDBusObjectPath &session_handle,
+                       const QString &app_id,
+                       const QVariantMap &options,
+                       QVariantMap &results);
+    uint SelectDevices(const QDBusObjectPath &handle,
+                       const QDBusObjectPath &session_handle,
+                       const QString &app_id,
+                       const QVariantMap &options,
+                       QVariantMap &results);
+    uint Start(const QDBusObjectPath &handle,
+               const QDBusObjectPath &session_handle,
+               const QString &app_id,
+               const QString &parent_window,
+               const QVariantMap &options,
+               QVariantMap &results);
+
+    void NotifyPointerMotion(const QDBusObjectPath &session_handle, const QVariantMap &options, double dx, double dy);
+    void NotifyPointerMotionAbsolute(const QDBusObjectPath &session_handle, const QVariantMap &options, uint stream, double x, double y);
+    void NotifyPointerButton(const QDBusObjectPath &session_handle, const QVariantMap &options, int button, uint state);
+    void NotifyPointerAxis(const QDBusObjectPath &session_handle, const QVariantMap &options, double dx, double dy);
+    void NotifyPointerAxisDiscrete(const QDBusObjectPath &session_handle, const QVariantMap &options, uint axis, int steps);
+    void NotifyKeyboardKeycode(const QDBusObjectPath &session_handle, const QVariantMap &options, int keycode, uint state);
+    void NotifyKeyboardKeysym(const QDBusObjectPath &session_handle, const QVariantMap &options, int keysym, uint state);
+
+private:
+    RemoteDesktopSession *startedSession(const QDBusObjectPath &session_handle) const;
+};
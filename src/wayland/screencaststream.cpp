@@ -0,0 +1,324 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "screencaststream.h"
+#include "protocols/common.h"
+
+#include <QLoggingCategory>
+
+#include <private/qwaylandscreen_p.h>
+
+#include <cstring>
+
+Q_DECLARE_LOGGING_CATEGORY(portalWayland);
+
+// Anything larger than a cursor means the two captures show different content
+static constexpr int MaxCursorSize = 256;
+
+ScreenCastStream::ScreenCastStream(PortalWaylandContext *context, QtWaylandClient::QWaylandScreen *screen, QObject *parent)
+    : QObject(parent)
+    , m_context(context)
+    , m_screen(screen)
+    , m_scheduler(new FrameScheduler(this))
+    , m_waiting(false)
+    , m_fullFrame(true)
+    , m_sequence(0)
+    , m_cursorMode(Embedded)
+    , m_cursorTimer(new QTimer(this))
+    , m_cursorSerial(0)
+    , m_sentCursorSerial(0)
+{
+    m_cursorTimer->setSingleShot(true);
+    connect(m_scheduler, &FrameScheduler::captureRequested, this, &ScreenCastStream::captureFrame);
+    connect(m_scheduler, &FrameScheduler::statisticsChanged, this, &ScreenCastStream::statisticsChanged);
+    // The overlay capture waits for damage, a cursor move, at most once per frame interval
+    connect(m_cursorTimer, &QTimer::timeout, this, [this] {
+        if (m_cursorSession)
+            m_cursorSession->requestFrame();
+    });
+}
+
+ScreenCastStream::~ScreenCastStream()
+{
+    stop();
+}
+
+void ScreenCastStream::setMaxFramerate(qreal framerate)
+{
+    m_scheduler->setMaxFramerate(framerate);
+}
+
+void ScreenCastStream::setBufferCount(int count)
+{
+    m_scheduler->setAvailableBuffers(count - m_pendingFrames.size());
+}
+
+void ScreenCastStream::setSourceRegion(const QRect &region)
+{
+    m_region = region;
+    if (m_session)
+        attachSession();
+}
+
+void ScreenCastStream::selectSource(uint32_t sourceHint)
+{
+    if (!m_context)
+        return;
+    auto captureManager = m_context->treelandCaptureManager();
+    auto captureContext = captureManager->getContext();
+    if (!captureContext) {
+        Q_EMIT sourceFailed();
+        return;
+    }
+    connect(captureContext, &TreeLandCaptureContext::sourceReady, this, [this, captureManager, captureContext](QRect region, uint32_t sourceType) {
+        captureManager->releaseCaptureContext(captureContext);
+        // The selector reports global coordinates, cast from the output holding the source
+        QtWaylandClient::QWaylandScreen *screen = nullptr;
+        for (auto candidate : waylandDisplay()->screens()) {
+            if (candidate->geometry().contains(region.center())) {
+                screen = candidate;
+                break;
+            }
+        }
+        if (!screen) {
+            Q_EMIT sourceFailed();
+            return;
+        }
+        m_screen = screen;
+        const QRect localRegion = region.translated(-screen->geometry().topLeft()).intersected(QRect(QPoint(0, 0), screen->geometry().size()));
+        setSourceRegion(sourceType == QtWayland::treeland_capture_context_v1::source_type_output ? QRect() : localRegion);
+        Q_EMIT sourceSelected(region, sourceType);
+    });
+    connect(captureContext, &TreeLandCaptureContext::sourceFailed, this, [this, captureManager, captureContext](uint32_t reason) {
+        qCDebug(portalWayland) << "screen cast source selection failed, reason:" << reason;
+        captureManager->releaseCaptureContext(captureContext);
+        Q_EMIT sourceFailed();
+    });
+    captureContext->selectSource(sourceHint, false, m_cursorMode == Embedded, nullptr);
+}
+
+void ScreenCastStream::setCursorMode(CursorMode mode)
+{
+    if (mode == m_cursorMode)
+        return;
+    m_cursorMode = mode;
+    if (m_session)
+        attachSession();
+}
+
+void ScreenCastStream::start()
+{
+    attachSession();
+    m_scheduler->start();
+}
+
+void ScreenCastStream::stop()
+{
+    m_scheduler->stop();
+    m_cursorTimer->stop();
+    detachSession();
+    const auto statistics = m_scheduler->statistics();
+    qCDebug(portalWayland) << "screen cast stream stopped, captured:" << statistics.capturedFrames
+                           << "dropped:" << statistics.droppedFrames
+                           << "skipped:" << statistics.skippedFrames
+                           << "average latency(us):" << statistics.averageLatency;
+}
+
+void ScreenCastStream::releaseBuffer(quint64 sequence)
+{
+    if (!m_pendingFrames.remove(sequence))
+        return;
+    m_scheduler->bufferReleased();
+}
+
+void ScreenCastStream::attachSession()
+{
+    detachSession();
+    if (!m_context || !m_screen)
+        return;
+    m_session = m_context->acquireCaptureSession(m_screen, m_cursorMode == Embedded, m_region);
+    if (!m_session)
+        return;
+    if (m_cursorMode == Metadata) {
+        m_cursorSession = m_context->acquireCaptureSession(m_screen, true, m_region);
+        if (m_cursorSession) {
+            connect(m_cursorSession, &CaptureSession::frameReady, this, &ScreenCastStream::onCursorFrameReady);
+            connect(m_cursorSession, &CaptureSession::frameFailed, this, [this] {
+                m_cursorTimer->start(int(1000 / m_scheduler->maxFramerate()));
+            });
+            m_cursorSession->requestFrame();
+        }
+    }
+    connect(m_session, &CaptureSession::frameReady, this, &ScreenCastStream::onFrameReady);
+    connect(m_session, &CaptureSession::frameFailed, this, &ScreenCastStream::onFrameFailed);
+    // Damage of the new session is relative to frames this stream never saw
+    m_fullFrame = true;
+    m_pendingDamage = QRegion();
+    if (m_waiting)
+        m_session->requestFrame();
+}
+
+void ScreenCastStream::detachSession()
+{
+    m_cursorTimer->stop();
+    m_plainBuffer.reset();
+    m_overlaidBuffer.reset();
+    if (m_cursorSession) {
+        disconnect(m_cursorSession, nullptr, this, nullptr);
+        if (m_context)
+            m_context->releaseCaptureSession(m_cursorSession);
+        m_cursorSession.clear();
+    }
+    if (!m_session)
+        return;
+    disconnect(m_session, nullptr, this, nullptr);
+    if (m_context)
+        m_context->releaseCaptureSession(m_session);
+    m_session.clear();
+}
+
+void ScreenCastStream::captureFrame()
+{
+    m_waiting = true;
+    if (!m_session) {
+        onFrameFailed();
+        return;
+    }
+    m_session->requestFrame();
+}
+
+void ScreenCastStream::onFrameReady(const CaptureBufferPtr &buffer)
+{
+    m_pendingDamage += buffer->damage;
+    if (m_cursorSession) {
+        m_plainBuffer = buffer;
+        updateCursor();
+    }
+    if (!m_waiting)
+        return;
+    m_waiting = false;
+
+    // The consumer has no content yet, its first frame is always complete
+    const QRegion damage = m_fullFrame ? QRegion(buffer->image.rect()) : m_pendingDamage;
+    if (damage.isEmpty()) {
+        m_scheduler->frameSkipped();
+        return;
+    }
+
+    // Dropped frames keep their damage pending for the next delivered one
+    if (!m_scheduler->frameCaptured())
+        return;
+
+    ScreenCastFrame castFrame;
+    castFrame.sequence = ++m_sequence;
+    castFrame.presentationTime = buffer->presentationTime;
+    castFrame.image = buffer->image;
+    castFrame.damage = damage;
+    if (m_cursorMode == Metadata)
+        castFrame.cursor = takeCursor();
+    m_pendingDamage = QRegion();
+    m_fullFrame = false;
+    m_pendingFrames.insert(castFrame.sequence, buffer);
+    Q_EMIT frameReady(castFrame);
+}
+
+void ScreenCastStream::onFrameFailed()
+{
+    if (!m_waiting)
+        return;
+    qCDebug(portalWayland) << "screen cast frame capture failed";
+    m_waiting = false;
+    m_scheduler->frameFailed();
+}
+
+void ScreenCastStream::onCursorFrameReady(const CaptureBufferPtr &buffer)
+{
+    m_overlaidBuffer = buffer;
+    updateCursor();
+    m_cursorTimer->start(int(1000 / m_scheduler->maxFramerate()));
+}
+
+void ScreenCastStream::updateCursor()
+{
+    if (!m_plainBuffer || !m_overlaidBuffer)
+        return;
+    ScreenCastCursor cursor;
+    // An outdated plain frame differs in content too, the next one settles it
+    if (!extractCursor(m_plainBuffer->image, m_overlaidBuffer->image, &cursor))
+        return;
+    const bool bitmapChanged = cursor.visible && cursor.bitmap != m_cursor.bitmap;
+    if (cursor.visible == m_cursor.visible && (!cursor.visible || cursor.position == m_cursor.position) && !bitmapChanged)
+        return;
+    if (!cursor.visible)
+        cursor.bitmap = m_cursor.bitmap;
+    m_cursor = cursor;
+    if (bitmapChanged)
+        ++m_cursorSerial;
+    if (m_scheduler->isActive())
+        Q_EMIT cursorChanged(takeCursor());
+}
+
+ScreenCastCursor ScreenCastStream::takeCursor()
+{
+    ScreenCastCursor cursor = m_cursor;
+    if (m_sentCursorSerial == m_cursorSerial)
+        cursor.bitmap = QImage();
+    m_sentCursorSerial = m_cursorSerial;
+    return cursor;
+}
+
+bool ScreenCastStream::extractCursor(const QImage &plain, const QImage &overlaid, ScreenCastCursor *cursor)
+{
+    if (plain.size() != overlaid.size() || plain.depth() != 32 || overlaid.depth() != 32)
+        return false;
+
+    // Rows are compared whole first, only the cursor rows are looked at per pixel
+    const int rowSize = plain.width() * 4;
+    int top = -1;
+    int bottom = -1;
+    int left = plain.width();
+    int right = -1;
+    for (int y = 0; y < plain.height(); ++y) {
+        const auto plainRow = reinterpret_cast<const quint32 *>(plain.constScanLine(y));
+        const auto overlaidRow = reinterpret_cast<const quint32 *>(overlaid.constScanLine(y));
+        if (memcmp(plainRow, overlaidRow, rowSize) == 0)
+            continue;
+        if (top < 0)
+            top = y;
+        bottom = y;
+        if (bottom - top >= MaxCursorSize)
+            return false;
+        for (int x = 0; x < plain.width(); ++x) {
+            if (plainRow[x] != overlaidRow[x]) {
+                left = qMin(left, x);
+                right = qMax(right, x);
+            }
+        }
+        if (right - left >= MaxCursorSize)
+            return false;
+    }
+
+    if (top < 0) {
+        // Off this source or hidden by the compositor
+        cursor->visible = false;
+        cursor->bitmap = QImage();
+        return true;
+    }
+
+    const QRect rect(QPoint(left, top), QPoint(right, bottom));
+    QImage bitmap(rect.size(), QImage::Format_ARGB32);
+    for (int y = 0; y < rect.height(); ++y) {
+        const auto plainRow = reinterpret_cast<const quint32 *>(plain.constScanLine(rect.top() + y)) + rect.left();
+        const auto overlaidRow = reinterpret_cast<const quint32 *>(overlaid.constScanLine(rect.top() + y)) + rect.left();
+        auto bitmapRow = reinterpret_cast<quint32 *>(bitmap.scanLine(y));
+        // Unchanged pixels are transparent, blended edges come out opaque
+        for (int x = 0; x < rect.width(); ++x)
+            bitmapRow[x] = plainRow[x] == overlaidRow[x] ? 0 : overlaidRow[x] | 0xff000000;
+    }
+    cursor->visible = true;
+    cursor->position = rect.topLeft();
+    cursor->hotspot = QPoint(0, 0);
+    cursor->bitmap = bitmap;
+    return true;
+}
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "capturesession.h"
+#include "framescheduler.h"
+#include "portalwaylandcontext.h"
+
+#include <QHash>
+#include <QImage>
+#include <QPointer>
+#include <QRegion>
+#include <QTimer>
+
+namespace QtWaylandClient {
+class QWaylandScreen;
+}
+
+struct ScreenCastCursor
+{
+    bool visible = false;
+    QPoint position; // relative to the stream source
+    QPoint hotspot;
+    QImage bitmap; // only set when it changed since the last update sent
+};
+
+struct ScreenCastFrame
+{
+    quint64 sequence = 0;
+    quint64 presentationTime = 0; // nanoseconds
+    QImage image;
+    QRegion damage; // changed area since the previous frame of this stream
+    ScreenCastCursor cursor; // only filled in CursorMode::Metadata
+};
+
+// Hands frames of one output, or a region of it, to a consumer, paced by its own
+// scheduler. Streams of the same source share a CaptureSession. Every delivered frame
+// occupies one consumer buffer until releaseBuffer() is called with its sequence.
+class ScreenCastStream : public QObject
+{
+    Q_OBJECT
+public:
+    // Values match the cursor_mode of org.freedesktop.impl.portal.ScreenCast.
+    // The compositor exposes neither the cursor position nor its image, in
+    // Metadata mode both come from comparing a capture with the overlay
+    // cursor against the plain one.
+    enum CursorMode {
+        Hidden = 1,
+        Embedded = 2,
+        Metadata = 4,
+    };
+
+    ScreenCastStream(PortalWaylandContext *context, QtWaylandClient::QWaylandScreen *screen, QObject *parent = nullptr);
+    ~ScreenCastStream() override;
+
+    inline FrameScheduler *scheduler() const { return m_scheduler; }
+    inline FrameScheduler::Statistics statistics() const { return m_scheduler->statistics(); }
+
+    void setMaxFramerate(qreal framerate);
+    void setBufferCount(int count);
+    // Crop to a region in output logical coordinates, a null region casts the whole output
+    void setSourceRegion(const QRect &region);
+    inline QRect sourceRegion() const { return m_region; }
+    // Let the user pick an output, window or region through the treeland selector
+    void selectSource(uint32_t sourceHint);
+    void setCursorMode(CursorMode mode);
+    inline CursorMode cursorMode() const { return m_cursorMode; }
+    void start();
+    void stop();
+    void releaseBuffer(quint64 sequence);
+
+    // The cursor is where overlaid differs from plain, the hotspot is its
+    // top left corner. Returns false if more than a cursor differs, content
+    // changed between the two captures then.
+    static bool extractCursor(const QImage &plain, const QImage &overlaid, ScreenCastCursor *cursor);
+
+Q_SIGNALS:
+    void frameReady(const ScreenCastFrame &frame);
+    void sourceSelected(const QRect &region, uint32_t sourceType);
+    void sourceFailed();
+    void statisticsChanged();
+    // Cursor moved or changed between frames, cheap update without a new frame
+    void cursorChanged(const ScreenCastCursor &cursor);
+
+private:
+    void attachSession();
+    void detachSession();
+    void captureFrame();
+    void onFrameReady(const CaptureBufferPtr &buffer);
+    void onFrameFailed();
+    void onCursorFrameReady(const CaptureBufferPtr &buffer);
+    void updateCursor();
+    ScreenCastCursor takeCursor();
+
+    QPointer<PortalWaylandContext> m_context;
+    QtWaylandClient::QWaylandScreen *m_screen;
+    QRect m_region;
+    FrameScheduler *m_scheduler;
+    QPointer<CaptureSession> m_session;
+    bool m_waiting;
+    bool m_fullFrame;
+    quint64 m_sequence;
+    // Damage of session frames this stream did not deliver
+    QRegion m_pendingDamage;
+    CursorMode m_cursorMode;
+    // Metadata mode: the overlay capture of the same source and the latest
+    // frame of both sessions
+    QPointer<CaptureSession> m_cursorSession;
+    CaptureBufferPtr m_plainBuffer;
+    CaptureBufferPtr m_overlaidBuffer;
+    QTimer *m_cursorTimer;
+    ScreenCastCursor m_cursor;
+    quint64 m_cursorSerial;
+    quint64 m_sentCursorSerial;
+    // Frames owned by the consumer, the shm memory stays mapped until released
+    QHash<quint64, CaptureBufferPtr> m_pendingFrames;
+};
@@ -12,6 +12,7 @@
 #include <QDir>
 #include <QRegion>
 #include <QStandardPaths>
+#include <QScopeGuard>
 
 #include <private/qwaylandscreen_p.h>
 
@@ -38,8 +39,9 @@ uint ScreenshotPortalWayland::PickColor(const QDBusObjectPath &handle,
     return 0;
 }
 
-QString ScreenshotPortalWayland::fullScreenShot()
+QString ScreenshotPortalWayland::fullScreenShot(Request *request)
 {
+    const CancellationToken token = request->token();
     std::list<std::shared_ptr<ScreenCaptureInfo>> captureList;
     int pendingCapture = 0;
     auto screenCopyManager = context()->screenCopyManager();
@@ -55,20 +57,30 @@ QString ScreenshotPortalWayland::fullScreenShot()
         info->screen = screen;
         ++pendingCapture;
         captureList.push_back(info);
-        connect(info->capturedFrame, &ScreenCopyFrame::ready, this, [&formatLast, info, &pendingCapture, &eventLoop, this](QImage image) {
+        // Scoped to the event loop, frames may still report after a cancelled call returned
+        connect(info->capturedFrame, &ScreenCopyFrame::ready, &eventLoop, [&formatLast, info, &pendingCapture, &eventLoop](QImage image) {
             info->capturedImage = image;
             formatLast = info->capturedImage.format();
             if (--pendingCapture == 0) {
                 eventLoop.quit();
             }
         });
-        connect(info->capturedFrame, &ScreenCopyFrame::failed, this, [&pendingCapture, &eventLoop]{
+        connect(info->capturedFrame, &ScreenCopyFrame::failed, &eventLoop, [&pendingCapture, &eventLoop]{
             if (--pendingCapture == 0) {
                 eventLoop.quit();
             }
         });
     }
-    eventLoop.exec();
+    connect(request, &Request::closeRequested, &eventLoop, &QEventLoop::quit);
+    if (pendingCapture > 0)
+        eventLoop.exec();
+    // Frames go back to the compositor whether they are used or not
+    auto releaseFrames = qScopeGuard([&captureList, screenCopyManager] {
+        for (const auto &info : std::as_const(captureList))
+            screenCopyManager->releaseFrame(info->capturedFrame);
+    });
+    if (token.isCancelled())
+        return "";
     // Cat them according to layout
     QImage image(outputRegion.boundingRect().size(), formatLast);
     QPainter p(&image);
@@ -95,13 +107,17 @@ QString ScreenshotPortalWayland::fullScreenShot()
         return "";
     }
 }
-QString ScreenshotPortalWayland::captureInteractively()
+QString ScreenshotPortalWayland::captureInteractively(Request *request)
 {
+    const CancellationToken token = request->token();
     auto captureManager = context()->treelandCaptureManager();
     auto captureContext = captureManager->getContext();
     if (!captureContext) {
         return "";
     }
+    auto releaseContext = qScopeGuard([captureManager, captureContext] {
+        captureManager->releaseCaptureContext(captureContext);
+    });
     captureContext->selectSource(QtWayland::treeland_capture_context_v1::source_type_output
                                          | QtWayland::treeland_capture_context_v1::source_type_window
                                          | QtWayland::treeland_capture_context_v1::source_type_region
@@ -109,17 +125,25 @@ QString ScreenshotPortalWayland::captureInteractively()
                                  , false
                                  ,nullptr);
     QEventLoop loop;
-    connect(captureContext, &TreeLandCaptureContext::sourceReady, &loop, &QEventLoop::quit);
+    connect(request, &Request::closeRequested, &loop, &QEventLoop::quit);
+    bool sourceReady = false;
+    connect(captureContext, &TreeLandCaptureContext::sourceReady, &loop, [&sourceReady, &loop] {
+        sourceReady = true;
+        loop.quit();
+    });
+    connect(captureContext, &TreeLandCaptureContext::sourceFailed, &loop, &QEventLoop::quit);
     loop.exec();
+    if (token.isCancelled() || !sourceReady)
+        return "";
     auto frame = captureContext->frame();
     QImage result;
-    connect(frame, &TreeLandCaptureFrame::ready, this, [this, &result, &loop](QImage image) {
+    connect(frame, &TreeLandCaptureFrame::ready, &loop, [&result, &loop](QImage image) {
         result = image;
         loop.quit();
     });
     connect(frame, &TreeLandCaptureFrame::failed, &loop, &QEventLoop::quit);
     loop.exec();
-    if (result.isNull()) return "";
+    if (token.isCancelled() || result.isNull()) return "";
     auto saveBasePath = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
     QDir saveBaseDir(saveBasePath);
     if (!saveBaseDir.exists()) return "";
@@ -140,11 +164,21 @@ uint ScreenshotPortalWayland::Screenshot(const QDBusObjectPath &handle,
     if (options["modal"].toBool()) {
         // TODO if modal, we should block parent_window
     }
+    // Closing deletes the request from within the capture loops, keep the token
+    QPointer<Request> request = new Request(handle, QVariant(), this);
+    const CancellationToken token = request->token();
+    auto deleteRequest = qScopeGuard([request] {
+        if (request)
+            request->deleteLater();
+    });
     QString filePath;
     if (options["interactive"].toBool()) {
-        filePath = captureInteractively();
+        filePath = captureInteractively(request);
     } else {
-        filePath = fullScreenShot();
+        filePath = fullScreenShot(request);
+    }
+    if (token.isCancelled()) {
+        return 2;
     }
     if (filePath.isEmpty()) {
         return 1;
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "abstractwaylandportal.h"
+#include "request.h"
 
 #include <QDBusObjectPath>
 #include <QObject>
@@ -17,8 +18,9 @@ class ScreenshotPortalWayland : public AbstractWaylandPortal
 public:
     ScreenshotPortalWayland(PortalWaylandContext *context);
 
-    QString fullScreenShot();
-    QString captureInteractively();
+    // Both give up and return an empty path once the request is closed
+    QString fullScreenShot(Request *request);
+    QString captureInteractively(Request *request);
 
 public Q_SLOTS:
     uint PickColor(const QDBusObjectPath &handle,
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "applicationindex.h"
+
+#include <QDBusObjectPath>
+#include <QObject>
+
+static const QString ApplicationManagerService = QStringLiteral("org.desktopspec.ApplicationManager1");
+static const QString ApplicationManagerPath = QStringLiteral("/org/desktopspec/ApplicationManager1");
+static const QString ApplicationInterface = QStringLiteral("org.desktopspec.ApplicationManager1.Application");
+static constexpr int ApplicationCount = 5000;
+
+// Serves the ObjectManager part of ApplicationManager1 with generated applications
+class ApplicationManagerStandIn : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.desktopspec.DBus.ObjectManager")
+
+public:
+    explicit ApplicationManagerStandIn(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+        for (int i = 0; i < ApplicationCount; ++i)
+            m_objects.insert(path(i), application(i));
+    }
+
+    void add(int i, const QString &suffix = QString())
+    {
+        m_objects.insert(path(i), application(i, suffix));
+        Q_EMIT InterfacesAdded(path(i), application(i, suffix));
+    }
+
+    void remove(int i)
+    {
+        m_objects.remove(path(i));
+        Q_EMIT InterfacesRemoved(path(i), { ApplicationInterface });
+    }
+
+    // Gone without a signal, as if it went while the manager was not running
+    void forget(int i) { m_objects.remove(path(i)); }
+
+public Q_SLOTS:
+    ObjectMap GetManagedObjects() const { return m_objects; }
+
+Q_SIGNALS:
+    void InterfacesAdded(const QDBusObjectPath &path, const ObjectInterfaceMap &interfaces);
+    void InterfacesRemoved(const QDBusObjectPath &path, const QStringList &interfaces);
+
+private:
+    static QDBusObjectPath path(int i)
+    {
+        return QDBusObjectPath(ApplicationManagerPath + QStringLiteral("/app_%1").arg(i, 5, 10, QLatin1Char('0')));
+    }
+
+    static ObjectInterfaceMap application(int i, const QString &suffix = QString())
+    {
+        const QString name = QStringLiteral("Application %1").arg(i) + suffix;
+        QVariantMap properties;
+        properties.insert(QStringLiteral("ID"), QStringLiteral("org.example.app%1").arg(i));
+        properties.insert(QStringLiteral("DisplayName"), QVariant::fromValue(PropMap{ { QStringLiteral("Name"), { { QStringLiteral("default"), name } } } }));
+        properties.insert(QStringLiteral("Icons"), QVariant::fromValue(PropMap{ { QStringLiteral("default"), { { QStringLiteral("default"), QStringLiteral("application-x-executable") } } } }));
+        properties.insert(QStringLiteral("Keywords"), QStringList{ QStringLiteral("example"), QStringLiteral("app%1").arg(i) });
+        return { { ApplicationInterface, properties } };
+    }
+
+    ObjectMap m_objects;
+};
@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "appchooserdelegate.h"
+#include "appchooserdialog.h"
+#include "appgridview.h"
+#include "applicationindex.h"
+#include "applicationmanagerstandin.h"
+
+#include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QFile>
+#include <QScrollBar>
+#include <QStandardPaths>
+#include <QStringListModel>
+#include <QtTest>
+
+// Timings of the app chooser with a synthetic ApplicationManager1, run by hand
+class bench_AppChooser : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void resize();
+    void scroll();
+    void resizeScaling_data();
+    void resizeScaling();
+
+private:
+    ApplicationManagerStandIn *m_manager = nullptr;
+    AppChooserDialog *m_dialog = nullptr;
+    AppGridView *m_view = nullptr;
+};
+
+void bench_AppChooser::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    // A snapshot of an earlier run would hide whether the enumeration works
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                  + QStringLiteral("/xdg-desktop-portal-dde/applications"));
+
+    auto bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected())
+        QSKIP("No session bus");
+    qDBusRegisterMetaType<ObjectInterfaceMap>();
+    qDBusRegisterMetaType<ObjectMap>();
+    qDBusRegisterMetaType<PropMap>();
+
+    m_dialog = new AppChooserDialog;
+    m_view = m_dialog->findChild<AppGridView *>();
+    QVERIFY(m_view);
+    m_dialog->resize(1000, 600);
+    m_dialog->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_dialog));
+
+    ApplicationIndex::instance()->load();
+    m_manager = new ApplicationManagerStandIn(this);
+    QVERIFY(bus.registerObject(ApplicationManagerPath, m_manager, QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals));
+    if (!bus.registerService(ApplicationManagerService))
+        QSKIP("ApplicationManager1 is running on this bus, run the benchmark in its own bus");
+    QTRY_COMPARE_WITH_TIMEOUT(m_view->model()->rowCount(), ApplicationCount, 10000);
+}
+
+void bench_AppChooser::cleanupTestCase()
+{
+    delete m_dialog;
+    QDBusConnection::sessionBus().unregisterService(ApplicationManagerService);
+}
+
+void bench_AppChooser::resize()
+{
+    bool wide = false;
+    QBENCHMARK {
+        wide = !wide;
+        m_dialog->resize(wide ? 1200 : 800, 600);
+        m_view->viewport()->repaint();
+    }
+}
+
+void bench_AppChooser::scroll()
+{
+    QScrollBar *scrollBar = m_view->verticalScrollBar();
+    QBENCHMARK {
+        scrollBar->setValue((scrollBar->value() + scrollBar->pageStep()) % (scrollBar->maximum() + 1));
+        m_view->viewport()->repaint();
+    }
+}
+
+void bench_AppChooser::resizeScaling_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("500") << 500;
+    QTest::newRow("5000") << 5000;
+    QTest::newRow("50000") << 50000;
+}
+
+void bench_AppChooser::resizeScaling()
+{
+    // Compare the rows, a resize should cost the same for all of them
+    QFETCH(int, count);
+    QStringList names;
+    names.reserve(count);
+    for (int i = 0; i < count; ++i)
+        names.append(QStringLiteral("Application %1").arg(i));
+    QStringListModel model(names);
+
+    AppGridView view;
+    view.setItemDelegate(new AppChooserDelegate(&view));
+    view.setModel(&model);
+    view.resize(1000, 600);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    bool wide = false;
+    QBENCHMARK {
+        wide = !wide;
+        view.resize(wide ? 1200 : 800, 600);
+        view.viewport()->repaint();
+    }
+}
+
+QTEST_MAIN(bench_AppChooser)
+
+#include "bench_appchooser.moc"
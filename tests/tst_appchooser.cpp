@@ -0,0 +1,196 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "appchooserdelegate.h"
+#include "appchooserdialog.h"
+#include "appchoosermodel.h"
+#include "appgridview.h"
+#include "applicationindex.h"
+#include "applicationmanagerstandin.h"
+
+#include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QFile>
+#include <QScrollBar>
+#include <QStandardPaths>
+#include <QStringListModel>
+#include <QtTest>
+
+class CountingDelegate : public AppChooserDelegate
+{
+public:
+    using AppChooserDelegate::AppChooserDelegate;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override
+    {
+        ++paints;
+        AppChooserDelegate::paint(painter, option, index);
+    }
+
+    mutable int paints = 0;
+};
+
+class tst_AppChooser : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void rowsArriveWhileOpen();
+    void modelUpdatesPerRow();
+    void paintsVisibleCellsOnly_data();
+    void paintsVisibleCellsOnly();
+
+private:
+    ApplicationManagerStandIn *m_manager = nullptr;
+    AppChooserDialog *m_dialog = nullptr;
+    AppGridView *m_view = nullptr;
+};
+
+void tst_AppChooser::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    // A snapshot of an earlier run would hide whether the enumeration works
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                  + QStringLiteral("/xdg-desktop-portal-dde/applications"));
+
+    auto bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected())
+        QSKIP("No session bus");
+    qDBusRegisterMetaType<ObjectInterfaceMap>();
+    qDBusRegisterMetaType<ObjectMap>();
+    qDBusRegisterMetaType<PropMap>();
+
+    m_dialog = new AppChooserDialog;
+    m_view = m_dialog->findChild<AppGridView *>();
+    QVERIFY(m_view);
+    m_dialog->resize(1000, 600);
+    m_dialog->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_dialog));
+
+    // The dialog is open before the manager shows up, as on a slow login
+    ApplicationIndex::instance()->load();
+    m_manager = new ApplicationManagerStandIn(this);
+    QVERIFY(bus.registerObject(ApplicationManagerPath, m_manager, QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals));
+    if (!bus.registerService(ApplicationManagerService))
+        QSKIP("ApplicationManager1 is running on this bus, run the test in its own bus");
+}
+
+void tst_AppChooser::cleanupTestCase()
+{
+    delete m_dialog;
+    QDBusConnection::sessionBus().unregisterService(ApplicationManagerService);
+}
+
+void tst_AppChooser::rowsArriveWhileOpen()
+{
+    QTRY_COMPARE_WITH_TIMEOUT(m_view->model()->rowCount(), ApplicationCount, 10000);
+    const QSize cell = AppChooserDelegate().sizeHint(QStyleOptionViewItem(), QModelIndex());
+    const int columns = qMax(1, m_view->viewport()->width() / cell.width());
+    auto expectedMaximum = [&](int count) {
+        return (count + columns - 1) / columns * cell.height() - m_view->viewport()->height();
+    };
+    QCOMPARE(m_view->verticalScrollBar()->maximum(), expectedMaximum(ApplicationCount));
+
+    // A single new app is inserted, not a reset, and must still show up
+    m_manager->add(ApplicationCount);
+    QTRY_COMPARE(m_view->model()->rowCount(), ApplicationCount + 1);
+    QCOMPARE(m_view->verticalScrollBar()->maximum(), expectedMaximum(ApplicationCount + 1));
+}
+
+void tst_AppChooser::modelUpdatesPerRow()
+{
+    QTRY_VERIFY(m_view->model()->rowCount() > ApplicationCount);
+    AppChooserModel chooserModel;
+    QAbstractItemModel *model = &chooserModel;
+    const int count = model->rowCount();
+    QCOMPARE(count, ApplicationCount + 1);
+    QSignalSpy inserted(model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy changed(model, &QAbstractItemModel::dataChanged);
+    QSignalSpy reset(model, &QAbstractItemModel::modelReset);
+    auto rowOf = [](const QSignalSpy &spy) {
+        return std::make_pair(spy.last().at(1).toInt(), spy.last().at(2).toInt());
+    };
+
+    // Rows follow the object paths, app 2500 sits in the middle
+    m_manager->remove(2500);
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(rowOf(removed), std::make_pair(2500, 2500));
+    m_manager->add(2500);
+    QTRY_COMPARE(inserted.count(), 1);
+    QCOMPARE(rowOf(inserted), std::make_pair(2500, 2500));
+
+    m_manager->add(2500, QStringLiteral(" (updated)"));
+    QTRY_COMPARE(changed.count(), 1);
+    QCOMPARE(changed.last().at(0).toModelIndex().row(), 2500);
+    QCOMPARE(changed.last().at(1).toModelIndex().row(), 2500);
+    QCOMPARE(model->index(2500, 0).data(AppChooserModel::NameRole).toString(), QStringLiteral("Application 2500 (updated)"));
+
+    // Preferred apps come first, and are found there when they go
+    chooserModel.setPreferredApps({ QStringLiteral("org.example.app4000") });
+    QCOMPARE(model->index(0, 0).data(AppChooserModel::DataRole).toString(), QStringLiteral("org.example.app4000"));
+    reset.clear();
+    removed.clear();
+    m_manager->remove(4000);
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(rowOf(removed), std::make_pair(0, 0));
+    m_manager->add(4000);
+    QTRY_COMPARE(inserted.count(), 2);
+    QCOMPARE(rowOf(inserted), std::make_pair(0, 0));
+
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(model->rowCount(), count);
+}
+
+void tst_AppChooser::paintsVisibleCellsOnly_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("500") << 500;
+    QTest::newRow("5000") << 5000;
+    QTest::newRow("50000") << 50000;
+}
+
+void tst_AppChooser::paintsVisibleCellsOnly()
+{
+    // Painting must not grow with the number of rows, only what is visible is drawn
+    QFETCH(int, count);
+    QStringList names;
+    names.reserve(count);
+    for (int i = 0; i < count; ++i)
+        names.append(QStringLiteral("Application %1").arg(i));
+    QStringListModel model(names);
+
+    AppGridView view;
+    auto delegate = new CountingDelegate(&view);
+    view.setItemDelegate(delegate);
+    view.setModel(&model);
+    view.resize(1000, 600);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    const QSize cell = delegate->sizeHint(QStyleOptionViewItem(), QModelIndex());
+    const int columns = qMax(1, view.viewport()->width() / cell.width());
+    // A partly shown row at the top and at the bottom
+    const int visibleCells = columns * (view.viewport()->height() / cell.height() + 2);
+
+    for (int value : { 0, view.verticalScrollBar()->maximum() / 2, view.verticalScrollBar()->maximum() }) {
+        view.verticalScrollBar()->setValue(value);
+        delegate->paints = 0;
+        view.viewport()->repaint();
+        QVERIFY(delegate->paints > 0);
+        QVERIFY2(delegate->paints <= visibleCells, qPrintable(QStringLiteral("%1 cells painted, %2 visible").arg(delegate->paints).arg(visibleCells)));
+    }
+
+    view.resize(1200, 600);
+    delegate->paints = 0;
+    view.viewport()->repaint();
+    QVERIFY(delegate->paints <= qMax(1, view.viewport()->width() / cell.width()) * (view.viewport()->height() / cell.height() + 2));
+}
+
+QTEST_MAIN(tst_AppChooser)
+
+#include "tst_appchooser.moc"
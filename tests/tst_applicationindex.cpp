@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "applicationindex.h"
+#include "applicationmanagerstandin.h"
+
+#include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtTest>
+
+static QString applicationPath(int i)
+{
+    return ApplicationManagerPath + QStringLiteral("/app_%1").arg(i, 5, 10, QLatin1Char('0'));
+}
+
+class tst_ApplicationIndex : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void enumeratesOnRegistration();
+    void followsSignals();
+    void enumeratesAgainOnRestart();
+    void writesSnapshot();
+
+private:
+    bool registerManager();
+
+    ApplicationManagerStandIn *m_manager = nullptr;
+    QString m_snapshotFile;
+};
+
+void tst_ApplicationIndex::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_snapshotFile = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QStringLiteral("/xdg-desktop-portal-dde/applications");
+    QFile::remove(m_snapshotFile);
+
+    if (!QDBusConnection::sessionBus().isConnected())
+        QSKIP("No session bus");
+    qDBusRegisterMetaType<ObjectInterfaceMap>();
+    qDBusRegisterMetaType<ObjectMap>();
+    qDBusRegisterMetaType<PropMap>();
+    m_manager = new ApplicationManagerStandIn(this);
+}
+
+void tst_ApplicationIndex::cleanupTestCase()
+{
+    QDBusConnection::sessionBus().unregisterService(ApplicationManagerService);
+    QDBusConnection::sessionBus().unregisterObject(ApplicationManagerPath);
+}
+
+bool tst_ApplicationIndex::registerManager()
+{
+    auto bus = QDBusConnection::sessionBus();
+    bus.registerObject(ApplicationManagerPath, m_manager, QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals);
+    return bus.registerService(ApplicationManagerService);
+}
+
+void tst_ApplicationIndex::enumeratesOnRegistration()
+{
+    auto index = ApplicationIndex::instance();
+    QSignalSpy reset(index, &ApplicationIndex::reset);
+    // Nothing serves ApplicationManager1 yet, the index waits for it
+    index->load();
+    QVERIFY(!index->isLoaded());
+    if (!registerManager())
+        QSKIP("ApplicationManager1 is running on this bus, run the test in its own bus");
+
+    QTRY_VERIFY_WITH_TIMEOUT(index->isLoaded(), 10000);
+    QCOMPARE(reset.count(), 1);
+    QCOMPARE(index->count(), ApplicationCount);
+
+    const auto application = index->application(applicationPath(42));
+    QCOMPARE(application.appId, QStringLiteral("org.example.app42"));
+    QCOMPARE(application.name, QStringLiteral("Application 42"));
+    QCOMPARE(application.icon, QStringLiteral("application-x-executable"));
+    QCOMPARE(application.keywords, QStringList({ QStringLiteral("example"), QStringLiteral("app42") }));
+}
+
+void tst_ApplicationIndex::followsSignals()
+{
+    auto index = ApplicationIndex::instance();
+    QTRY_VERIFY(index->isLoaded());
+    QSignalSpy reset(index, &ApplicationIndex::reset);
+    QSignalSpy added(index, &ApplicationIndex::applicationAdded);
+    QSignalSpy changed(index, &ApplicationIndex::applicationChanged);
+    QSignalSpy removed(index, &ApplicationIndex::applicationRemoved);
+
+    m_manager->add(ApplicationCount);
+    QTRY_COMPARE(added.count(), 1);
+    QCOMPARE(added.last().at(0).toString(), applicationPath(ApplicationCount));
+    QCOMPARE(index->count(), ApplicationCount + 1);
+
+    // Added again is a change of a known application
+    m_manager->add(7, QStringLiteral(" (updated)"));
+    QTRY_COMPARE(changed.count(), 1);
+    QCOMPARE(changed.last().at(0).toString(), applicationPath(7));
+    QCOMPARE(index->application(applicationPath(7)).name, QStringLiteral("Application 7 (updated)"));
+
+    m_manager->remove(ApplicationCount);
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(removed.last().at(0).toString(), applicationPath(ApplicationCount));
+    QCOMPARE(index->count(), ApplicationCount);
+    QVERIFY(index->application(applicationPath(ApplicationCount)).path.isEmpty());
+
+    // Never enumerated again for a single change
+    QCOMPARE(added.count(), 1);
+    QCOMPARE(reset.count(), 0);
+}
+
+void tst_ApplicationIndex::enumeratesAgainOnRestart()
+{
+    auto index = ApplicationIndex::instance();
+    QTRY_VERIFY(index->isLoaded());
+    QSignalSpy reset(index, &ApplicationIndex::reset);
+    auto bus = QDBusConnection::sessionBus();
+
+    // Unchanged across the restart, nobody hears about it
+    QVERIFY(bus.unregisterService(ApplicationManagerService));
+    QVERIFY(bus.registerService(ApplicationManagerService));
+    QTest::qWait(500);
+    QCOMPARE(reset.count(), 0);
+
+    // Missed while it was gone, caught up by the enumeration
+    QVERIFY(bus.unregisterService(ApplicationManagerService));
+    m_manager->forget(9);
+    QVERIFY(bus.registerService(ApplicationManagerService));
+    QTRY_COMPARE(reset.count(), 1);
+    QCOMPARE(index->count(), ApplicationCount - 1);
+    QVERIFY(index->application(applicationPath(9)).path.isEmpty());
+}
+
+void tst_ApplicationIndex::writesSnapshot()
+{
+    // Coalesced and written some seconds after the last change
+    QTRY_VERIFY_WITH_TIMEOUT(QFile::exists(m_snapshotFile), 15000);
+    QVERIFY(QFileInfo(m_snapshotFile).size() > 0);
+}
+
+QTEST_GUILESS_MAIN(tst_ApplicationIndex)
+#include "tst_applicationindex.moc"
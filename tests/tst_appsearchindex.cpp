@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "appsearchindex.h"
+
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtTest>
+
+using Entry = AppSearchIndex::Entry;
+
+static QList<Entry> applications()
+{
+    return {
+        { QStringLiteral("org.gnome.TextEditor"), QStringLiteral("Text Editor"), { QStringLiteral("notepad") } },
+        { QStringLiteral("org.gnome.gedit"), QStringLiteral("gedit"), {} },
+        { QStringLiteral("org.deepin.terminal"), QStringLiteral("Terminal"), { QStringLiteral("shell"), QStringLiteral("prompt") } },
+        { QStringLiteral("org.deepin.editor"), QStringLiteral("文本编辑器"), {} },
+        { QStringLiteral("org.example.texture"), QStringLiteral("Texture Viewer"), {} },
+    };
+}
+
+static QStringList appIds(const QList<Entry> &entries, const QList<int> &rows)
+{
+    QStringList ids;
+    for (int row : rows)
+        ids.append(entries.at(row).appId);
+    return ids;
+}
+
+class tst_AppSearchIndex : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void ranking_data();
+    void ranking();
+    void usage();
+    void incremental();
+};
+
+void tst_AppSearchIndex::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    // Usage counted by an earlier run would change the ranking
+    QSettings settings(QStringLiteral("deepin"), QStringLiteral("xdg-desktop-portal-dde"));
+    settings.remove(QStringLiteral("AppChooserUsage"));
+    settings.sync();
+}
+
+void tst_AppSearchIndex::ranking_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<QStringList>("expected");
+
+    const QString textEditor = QStringLiteral("org.gnome.TextEditor");
+    QTest::newRow("exact name") << QStringLiteral("text editor") << QStringList{ textEditor };
+    QTest::newRow("name prefix first") << QStringLiteral("tex")
+                                       << QStringList{ textEditor, QStringLiteral("org.example.texture") };
+    QTest::newRow("word prefixes") << QStringLiteral("te ed") << QStringList{ textEditor };
+    QTest::newRow("keyword") << QStringLiteral("shell") << QStringList{ QStringLiteral("org.deepin.terminal") };
+    QTest::newRow("id part") << QStringLiteral("gedit") << QStringList{ QStringLiteral("org.gnome.gedit") };
+    // Prefix of a word beats a match inside one
+    QTest::newRow("short") << QStringLiteral("ed")
+                           << QStringList{ textEditor, QStringLiteral("org.deepin.editor"), QStringLiteral("org.gnome.gedit") };
+    QTest::newRow("cjk inside a name") << QStringLiteral("编辑") << QStringList{ QStringLiteral("org.deepin.editor") };
+    QTest::newRow("single character") << QStringLiteral("器") << QStringList{ QStringLiteral("org.deepin.editor") };
+    QTest::newRow("no match") << QStringLiteral("browser") << QStringList();
+}
+
+void tst_AppSearchIndex::ranking()
+{
+    QFETCH(QString, query);
+    QFETCH(QStringList, expected);
+
+    const auto entries = applications();
+    AppSearchIndex index;
+    index.build(entries);
+    QCOMPARE(appIds(entries, index.search(query)), expected);
+}
+
+void tst_AppSearchIndex::usage()
+{
+    const QList<Entry> entries = {
+        { QStringLiteral("org.example.notes"), QStringLiteral("Notes"), {} },
+        { QStringLiteral("org.example.notebook"), QStringLiteral("Notebook"), {} },
+    };
+    AppSearchIndex index;
+    index.build(entries);
+    QCOMPARE(index.search(QStringLiteral("note")), (QList<int>{ 0, 1 }));
+
+    // Same quality, the app picked more often goes first
+    AppSearchIndex::recordUsage({ QStringLiteral("org.example.notebook") });
+    index.build(entries);
+    QCOMPARE(index.search(QStringLiteral("note")), (QList<int>{ 1, 0 }));
+}
+
+void tst_AppSearchIndex::incremental()
+{
+    // Single row updates must leave the same index as building it again
+    auto entries = applications();
+    AppSearchIndex index;
+    index.build(entries);
+
+    const Entry calculator{ QStringLiteral("org.deepin.calculator"), QStringLiteral("Calculator"), { QStringLiteral("math") } };
+    entries.insert(1, calculator);
+    index.insert(1, calculator);
+    entries.removeAt(3);
+    index.remove(3);
+    entries[0].name = QStringLiteral("Plain Text");
+    index.update(0, entries.at(0));
+    // Reuses the id of the removed row
+    const Entry textures{ QStringLiteral("org.example.textures"), QStringLiteral("Textures"), {} };
+    entries.append(textures);
+    index.insert(entries.size() - 1, textures);
+    QCOMPARE(index.count(), int(entries.size()));
+
+    AppSearchIndex built;
+    built.build(entries);
+    for (const char *query : { "te", "text", "calc", "math", "编辑", "shell", "editor", "tex", "e" })
+        QCOMPARE(index.search(QString::fromUtf8(query)), built.search(QString::fromUtf8(query)));
+}
+
+QTEST_GUILESS_MAIN(tst_AppSearchIndex)
+
+#include "tst_appsearchindex.moc"
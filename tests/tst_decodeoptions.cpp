@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "utils.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QtTest>
+
+namespace {
+struct TestOptions
+{
+    bool modal = true;
+    uint count = 7;
+    QString name;
+    QString current_folder;
+    QStringList files;
+    QVariant filters;
+};
+
+constexpr auto TestSchema = std::make_tuple(optionKey("modal", &TestOptions::modal),
+                                            optionKey("count", &TestOptions::count),
+                                            optionKey("name", &TestOptions::name),
+                                            optionKey("current_folder", &TestOptions::current_folder),
+                                            optionKey("files", &TestOptions::files),
+                                            optionKey("filters", &TestOptions::filters));
+} // namespace
+
+// Decodes options the way a portal does, as they arrived over the bus
+class OptionsReceiver : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.deepin.dde.portal.test.Options")
+
+public Q_SLOTS:
+    void Receive(const QVariantMap &options) { decoded = decodeOptions<TestOptions>(options, TestSchema); }
+
+public:
+    TestOptions decoded;
+};
+
+class tst_DecodeOptions : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void defaults();
+    void values();
+    void unknownKeys();
+    void byteStrings();
+    void overBus();
+};
+
+void tst_DecodeOptions::defaults()
+{
+    const auto options = decodeOptions<TestOptions>(QVariantMap(), TestSchema);
+    QCOMPARE(options.modal, true);
+    QCOMPARE(options.count, 7u);
+    QVERIFY(options.name.isNull());
+    QVERIFY(options.files.isEmpty());
+    QVERIFY(!options.filters.isValid());
+}
+
+void tst_DecodeOptions::values()
+{
+    const QVariantList filters{ QStringLiteral("Images") };
+    const auto options = decodeOptions<TestOptions>({ { QStringLiteral("modal"), false },
+                                                      { QStringLiteral("count"), 3u },
+                                                      { QStringLiteral("name"), QStringLiteral("report.odt") },
+                                                      { QStringLiteral("files"), QStringList{ QStringLiteral("a"), QStringLiteral("b") } },
+                                                      { QStringLiteral("filters"), filters } },
+                                                    TestSchema);
+    QCOMPARE(options.modal, false);
+    QCOMPARE(options.count, 3u);
+    QCOMPARE(options.name, QStringLiteral("report.odt"));
+    QCOMPARE(options.files, QStringList({ QStringLiteral("a"), QStringLiteral("b") }));
+    // Kept as is
+    QCOMPARE(options.filters, QVariant(filters));
+}
+
+void tst_DecodeOptions::unknownKeys()
+{
+    // Matching is exact, neither prefixes nor other cases are taken
+    const auto options = decodeOptions<TestOptions>({ { QStringLiteral("modality"), false },
+                                                      { QStringLiteral("Modal"), false },
+                                                      { QStringLiteral("nam"), QStringLiteral("x") },
+                                                      { QStringLiteral("handle_token"), QStringLiteral("t1") } },
+                                                    TestSchema);
+    QCOMPARE(options.modal, true);
+    QVERIFY(options.name.isNull());
+}
+
+void tst_DecodeOptions::byteStrings()
+{
+    const auto options = decodeOptions<TestOptions>({ { QStringLiteral("current_folder"), QByteArray("/home/user/Documents\0", 21) },
+                                                      { QStringLiteral("name"), QByteArray("no terminator") },
+                                                      { QStringLiteral("files"), QVariant::fromValue(QByteArrayList{ QByteArray("a.txt\0", 6), QByteArray("b.txt\0", 6) }) } },
+                                                    TestSchema);
+    QCOMPARE(options.current_folder, QStringLiteral("/home/user/Documents"));
+    QCOMPARE(options.name, QStringLiteral("no terminator"));
+    QCOMPARE(options.files, QStringList({ QStringLiteral("a.txt"), QStringLiteral("b.txt") }));
+}
+
+void tst_DecodeOptions::overBus()
+{
+    // aay is handed to the portal undemarshalled, only a real message shows that
+    auto bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected())
+        QSKIP("No session bus");
+    OptionsReceiver receiver;
+    const QString path = QStringLiteral("/org/deepin/dde/portal/test/options");
+    QVERIFY(bus.registerObject(path, &receiver, QDBusConnection::ExportAllSlots));
+
+    auto message = QDBusMessage::createMethodCall(bus.baseService(), path, QStringLiteral("org.deepin.dde.portal.test.Options"), QStringLiteral("Receive"));
+    const QVariantMap options{ { QStringLiteral("modal"), false },
+                               { QStringLiteral("current_folder"), QByteArray("/tmp\0", 5) },
+                               { QStringLiteral("files"), QVariant::fromValue(QByteArrayList{ QByteArray("a.txt\0", 6), QByteArray("b.txt\0", 6) }) } };
+    message << options;
+    const QDBusMessage reply = bus.call(message);
+    bus.unregisterObject(path);
+    QCOMPARE(reply.type(), QDBusMessage::ReplyMessage);
+
+    QCOMPARE(receiver.decoded.modal, false);
+    QCOMPARE(receiver.decoded.current_folder, QStringLiteral("/tmp"));
+    QCOMPARE(receiver.decoded.files, QStringList({ QStringLiteral("a.txt"), QStringLiteral("b.txt") }));
+}
+
+QTEST_GUILESS_MAIN(tst_DecodeOptions)
+#include "tst_decodeoptions.moc"
@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "wayland/framerecorder.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static constexpr quint64 Millisecond = 1000000;
+static const QSize FrameSize(64, 32);
+
+struct ParsedRecord
+{
+    FrameRecorder::RecordHeader header;
+    QList<QRect> rects;
+    QByteArray pixels;
+};
+
+static QList<ParsedRecord> parse(const QByteArray &dump)
+{
+    QList<ParsedRecord> records;
+    FrameRecorder::FileHeader fileHeader;
+    if (dump.size() < qsizetype(sizeof(fileHeader)))
+        return records;
+    memcpy(&fileHeader, dump.constData(), sizeof(fileHeader));
+    if (memcmp(fileHeader.magic, "DDEFRREC", sizeof(fileHeader.magic)) != 0)
+        return records;
+
+    qsizetype offset = sizeof(fileHeader);
+    for (quint32 i = 0; i < fileHeader.recordCount && offset < dump.size(); ++i) {
+        ParsedRecord record;
+        memcpy(&record.header, dump.constData() + offset, sizeof(record.header));
+        qsizetype position = offset + sizeof(record.header);
+        qsizetype pixelSize = 0;
+        for (quint32 r = 0; r < record.header.rectCount; ++r) {
+            qint32 geometry[4];
+            memcpy(geometry, dump.constData() + position, sizeof(geometry));
+            position += sizeof(geometry);
+            record.rects.append(QRect(geometry[0], geometry[1], geometry[2], geometry[3]));
+            pixelSize += qsizetype(geometry[2]) * geometry[3] * 4;
+        }
+        record.pixels = dump.mid(position, pixelSize);
+        records.append(record);
+        offset += record.header.size;
+    }
+    return records;
+}
+
+static ScreenCastFrame frame(quint64 sequence, quint64 time, const QRegion &damage = QRegion())
+{
+    ScreenCastFrame frame;
+    frame.sequence = sequence;
+    frame.presentationTime = time;
+    frame.image = QImage(FrameSize, QImage::Format_ARGB32);
+    frame.image.fill(0xff000000u | quint32(sequence * 0x010203));
+    frame.damage = damage;
+    return frame;
+}
+
+static QByteArray exported(const FrameRecorder &recorder)
+{
+    const int fd = recorder.exportFd();
+    if (fd < 0)
+        return QByteArray();
+    QFile file;
+    file.open(fd, QIODevice::ReadOnly, QFileDevice::AutoCloseHandle);
+    return file.readAll();
+}
+
+class tst_FrameRecorder : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void raw();
+    void damageCompressed();
+    void evictionKeepsKeyframe();
+    void duration();
+    void exportFd();
+};
+
+void tst_FrameRecorder::raw()
+{
+    FrameRecorder recorder(nullptr, 10, 1 << 20, FrameRecorder::Raw);
+    QVERIFY(recorder.isValid());
+    for (quint64 i = 0; i < 3; ++i)
+        recorder.append(frame(i, i * 10 * Millisecond, QRect(0, 0, 4, 4)));
+    QCOMPARE(recorder.frameCount(), 3);
+
+    const auto records = parse(exported(recorder));
+    QCOMPARE(records.size(), 3);
+    for (const ParsedRecord &record : records) {
+        QVERIFY(record.header.flags & FrameRecorder::Keyframe);
+        QCOMPARE(record.rects, QList<QRect>{ QRect(QPoint(0, 0), FrameSize) });
+        QCOMPARE(record.header.width, FrameSize.width());
+        QCOMPARE(record.header.height, FrameSize.height());
+        QCOMPARE(record.header.format, quint32(QImage::Format_ARGB32));
+    }
+    QCOMPARE(records.at(2).header.sequence, quint64(2));
+    QCOMPARE(records.at(2).header.presentationTime, 20 * Millisecond);
+}
+
+void tst_FrameRecorder::damageCompressed()
+{
+    FrameRecorder recorder(nullptr, 10, 1 << 20, FrameRecorder::DamageCompressed);
+    const QRect damage(4, 4, 8, 2);
+    recorder.append(frame(0, 0));
+    const ScreenCastFrame delta = frame(1, 10 * Millisecond, damage);
+    recorder.append(delta);
+    // Damage outside of the frame is clipped
+    recorder.append(frame(2, 20 * Millisecond, QRect(60, 30, 10, 10)));
+    // The keyframe interval passed
+    recorder.append(frame(3, 1100 * Millisecond, damage));
+
+    const auto records = parse(exported(recorder));
+    QCOMPARE(records.size(), 4);
+    QVERIFY(records.at(0).header.flags & FrameRecorder::Keyframe);
+    QVERIFY(!(records.at(1).header.flags & FrameRecorder::Keyframe));
+    QCOMPARE(records.at(1).rects, QList<QRect>{ damage });
+    QByteArray pixels;
+    for (int y = damage.top(); y <= damage.bottom(); ++y)
+        pixels.append(reinterpret_cast<const char *>(delta.image.constScanLine(y)) + damage.x() * 4, damage.width() * 4);
+    QCOMPARE(records.at(1).pixels, pixels);
+    QCOMPARE(records.at(2).rects, QList<QRect>{ QRect(60, 30, 4, 2) });
+    QVERIFY(records.at(3).header.flags & FrameRecorder::Keyframe);
+}
+
+void tst_FrameRecorder::evictionKeepsKeyframe()
+{
+    // Room for two full frames and some deltas
+    const qsizetype frameBytes = FrameSize.width() * FrameSize.height() * 4;
+    FrameRecorder recorder(nullptr, 10, frameBytes * 2 + 4096, FrameRecorder::DamageCompressed);
+    for (quint64 i = 0; i < 200; ++i) {
+        recorder.append(frame(i, i * Millisecond, QRect(0, 0, 8, 8)));
+        const auto records = parse(exported(recorder));
+        QVERIFY(!records.isEmpty());
+        QVERIFY2(records.first().header.flags & FrameRecorder::Keyframe, qPrintable(QString::number(i)));
+        QCOMPARE(records.last().header.sequence, i);
+    }
+    QVERIFY(recorder.frameCount() < 200);
+}
+
+void tst_FrameRecorder::duration()
+{
+    FrameRecorder recorder(nullptr, 1, 1 << 20, FrameRecorder::Raw);
+    for (quint64 i = 0; i <= 12; ++i)
+        recorder.append(frame(i, i * 250 * Millisecond));
+
+    // The last second, from 2 s to 3 s
+    const auto records = parse(exported(recorder));
+    QCOMPARE(records.size(), 5);
+    QCOMPARE(records.first().header.presentationTime, 2000 * Millisecond);
+    QCOMPARE(records.last().header.presentationTime, 3000 * Millisecond);
+
+    recorder.clear();
+    QCOMPARE(recorder.frameCount(), 0);
+}
+
+void tst_FrameRecorder::exportFd()
+{
+    FrameRecorder recorder(nullptr, 10, 1 << 20, FrameRecorder::DamageCompressed);
+    recorder.append(frame(0, 0));
+    recorder.append(frame(1, 10 * Millisecond, QRect(1, 1, 2, 2)));
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("recording"));
+    QVERIFY(recorder.dump(fileName));
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    const int fd = recorder.exportFd();
+    QVERIFY(fd >= 0);
+    // Receivers get a snapshot nobody can change under them
+    const int seals = fcntl(fd, F_GET_SEALS);
+    QVERIFY(seals & F_SEAL_WRITE);
+    QVERIFY(seals & F_SEAL_SEAL);
+    QVERIFY(write(fd, "x", 1) < 0);
+
+    QFile exportedFile;
+    QVERIFY(exportedFile.open(fd, QIODevice::ReadOnly, QFileDevice::AutoCloseHandle));
+    QCOMPARE(exportedFile.readAll(), file.readAll());
+}
+
+QTEST_GUILESS_MAIN(tst_FrameRecorder)
+
+#include "tst_framerecorder.moc"
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "wayland/framescheduler.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QtTest>
+
+class tst_FrameScheduler : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void noBufferNoCapture();
+    void waitsForReleasedBuffer();
+    void framerateCap();
+    void unrequestedFrames();
+    void skippedFrames();
+    void latency();
+    void stop();
+};
+
+void tst_FrameScheduler::noBufferNoCapture()
+{
+    FrameScheduler scheduler;
+    QSignalSpy requested(&scheduler, &FrameScheduler::captureRequested);
+    scheduler.start();
+    QTest::qWait(100);
+    QCOMPARE(requested.count(), 0);
+
+    scheduler.setAvailableBuffers(1);
+    QCOMPARE(requested.count(), 1);
+}
+
+void tst_FrameScheduler::waitsForReleasedBuffer()
+{
+    FrameScheduler scheduler;
+    scheduler.setMaxFramerate(100);
+    scheduler.setAvailableBuffers(1);
+    QSignalSpy requested(&scheduler, &FrameScheduler::captureRequested);
+    scheduler.start();
+    QCOMPARE(requested.count(), 1);
+    QVERIFY(scheduler.frameCaptured());
+    QCOMPARE(scheduler.availableBuffers(), 0);
+
+    // The consumer still holds the only buffer
+    QTest::qWait(100);
+    QCOMPARE(requested.count(), 1);
+
+    scheduler.bufferReleased();
+    QTRY_COMPARE(requested.count(), 2);
+}
+
+void tst_FrameScheduler::framerateCap()
+{
+    FrameScheduler scheduler;
+    scheduler.setMaxFramerate(20);
+    scheduler.setAvailableBuffers(1);
+    // Give every buffer back right away, only the cap limits the rate
+    connect(&scheduler, &FrameScheduler::captureRequested, &scheduler, [&scheduler] {
+        if (scheduler.frameCaptured())
+            scheduler.bufferReleased();
+    }, Qt::QueuedConnection);
+
+    QElapsedTimer clock;
+    clock.start();
+    scheduler.start();
+    QTest::qWait(500);
+    scheduler.stop();
+    const quint64 frames = scheduler.statistics().capturedFrames;
+    const quint64 limit = clock.elapsed() * 20 / 1000 + 1;
+    QVERIFY2(frames <= limit, qPrintable(QStringLiteral("%1 frames, at most %2").arg(frames).arg(limit)));
+    QVERIFY(frames >= 2);
+}
+
+void tst_FrameScheduler::unrequestedFrames()
+{
+    FrameScheduler scheduler;
+    scheduler.start();
+    // Pushed by the source while no buffer is free
+    QVERIFY(!scheduler.frameCaptured());
+    QCOMPARE(scheduler.statistics().droppedFrames, quint64(1));
+
+    scheduler.setAvailableBuffers(2);
+    QVERIFY(scheduler.frameCaptured());
+    // Right after the previous one, within the frame interval
+    QVERIFY(!scheduler.frameCaptured());
+    QCOMPARE(scheduler.statistics().capturedFrames, quint64(1));
+    QCOMPARE(scheduler.statistics().droppedFrames, quint64(2));
+}
+
+void tst_FrameScheduler::skippedFrames()
+{
+    FrameScheduler scheduler;
+    scheduler.setAvailableBuffers(1);
+    scheduler.start();
+    scheduler.frameSkipped();
+    QCOMPARE(scheduler.statistics().skippedFrames, quint64(1));
+    QCOMPARE(scheduler.statistics().droppedFrames, quint64(0));
+    // Nothing was sent, the buffer is still free
+    QCOMPARE(scheduler.availableBuffers(), 1);
+}
+
+void tst_FrameScheduler::latency()
+{
+    FrameScheduler scheduler;
+    scheduler.setAvailableBuffers(1);
+    scheduler.start();
+    QTest::qSleep(20);
+    QVERIFY(scheduler.frameCaptured());
+    QVERIFY(scheduler.statistics().lastLatency >= 20000);
+    QCOMPARE(scheduler.statistics().averageLatency, scheduler.statistics().lastLatency);
+}
+
+void tst_FrameScheduler::stop()
+{
+    FrameScheduler scheduler;
+    scheduler.setAvailableBuffers(1);
+    scheduler.start();
+    QVERIFY(scheduler.frameCaptured());
+    scheduler.stop();
+    QVERIFY(!scheduler.isActive());
+
+    QSignalSpy requested(&scheduler, &FrameScheduler::captureRequested);
+    scheduler.bufferReleased();
+    QTest::qWait(100);
+    QCOMPARE(requested.count(), 0);
+    QVERIFY(!scheduler.frameCaptured());
+}
+
+QTEST_GUILESS_MAIN(tst_FrameScheduler)
+
+#include "tst_framescheduler.moc"
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "mimehandlerindex.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+static bool writeFile(const QString &path, const QByteArray &contents)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(contents) == contents.size();
+}
+
+static const QByteArray UserList = "[Default Applications]\n"
+                                   "text/plain=user-editor.desktop\n"
+                                   "x-scheme-handler/example=browser.desktop\n"
+                                   "[Added Associations]\n"
+                                   "text/plain=added.desktop;\n"
+                                   "[Removed Associations]\n"
+                                   "text/plain=unwanted.desktop;\n";
+
+class tst_MimeHandlerIndex : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void handlers_data();
+    void handlers();
+    void followsChanges();
+
+private:
+    QTemporaryDir m_systemDir;
+    QString m_userList;
+};
+
+void tst_MimeHandlerIndex::initTestCase()
+{
+    QVERIFY(m_systemDir.isValid());
+    // Nothing of the machine running the test may leak in
+    QStandardPaths::setTestModeEnabled(true);
+    const QString configDir = m_systemDir.filePath(QStringLiteral("config"));
+    const QString dataDir = m_systemDir.filePath(QStringLiteral("data"));
+    qputenv("XDG_CONFIG_DIRS", QFile::encodeName(configDir));
+    qputenv("XDG_DATA_DIRS", QFile::encodeName(dataDir));
+    qputenv("XDG_CURRENT_DESKTOP", "DDE");
+
+    // The user list wins over the system ones, the desktop list over the generic one
+    m_userList = QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + QStringLiteral("/mimeapps.list");
+    QVERIFY(writeFile(m_userList, UserList));
+    QVERIFY(writeFile(configDir + QStringLiteral("/dde-mimeapps.list"),
+                      "[Default Applications]\n"
+                      "text/plain=system-editor.desktop\n"
+                      "[Added Associations]\n"
+                      "text/plain=system-added.desktop;added.desktop;\n"));
+    QVERIFY(writeFile(configDir + QStringLiteral("/mimeapps.list"),
+                      "[Added Associations]\n"
+                      "text/plain=generic-added.desktop;\n"));
+    QVERIFY(writeFile(dataDir + QStringLiteral("/applications/mimeinfo.cache"),
+                      "[MIME Cache]\n"
+                      "text/plain=unwanted.desktop;viewer.desktop;\n"
+                      "text/x-csrc=ide.desktop;\n"));
+}
+
+void tst_MimeHandlerIndex::cleanupTestCase()
+{
+    QFile::remove(m_userList);
+}
+
+void tst_MimeHandlerIndex::handlers_data()
+{
+    QTest::addColumn<QString>("contentType");
+    QTest::addColumn<QStringList>("expected");
+
+    const QStringList plain{ QStringLiteral("user-editor"), QStringLiteral("added"), QStringLiteral("system-added"),
+                             QStringLiteral("generic-added"), QStringLiteral("viewer") };
+    QTest::newRow("type") << QStringLiteral("text/plain") << plain;
+    // Own handlers first, then those of text/plain
+    QTest::newRow("parent") << QStringLiteral("text/x-csrc") << QStringList{ QStringLiteral("ide") } + plain;
+    QTest::newRow("alias") << QStringLiteral("text/x-c") << QStringList{ QStringLiteral("ide") } + plain;
+    // Not in the MIME database, still looked up by name
+    QTest::newRow("scheme") << QStringLiteral("x-scheme-handler/example") << QStringList{ QStringLiteral("browser") };
+    QTest::newRow("unknown") << QStringLiteral("application/x-nobody-handles-this") << QStringList();
+    QTest::newRow("empty") << QString() << QStringList();
+}
+
+void tst_MimeHandlerIndex::handlers()
+{
+    QFETCH(QString, contentType);
+    QFETCH(QStringList, expected);
+    QCOMPARE(MimeHandlerIndex::instance()->handlers(contentType), expected);
+}
+
+void tst_MimeHandlerIndex::followsChanges()
+{
+    auto index = MimeHandlerIndex::instance();
+    QVERIFY(!index->handlers(QStringLiteral("text/plain")).contains(QStringLiteral("unwanted")));
+
+    // Without the removal the cached association shows up again
+    QByteArray list = UserList;
+    list.truncate(list.indexOf("[Removed Associations]"));
+    QVERIFY(writeFile(m_userList, list));
+    QTRY_VERIFY(index->handlers(QStringLiteral("text/plain")).contains(QStringLiteral("unwanted")));
+    QCOMPARE(index->handlers(QStringLiteral("text/plain")).constLast(), QStringLiteral("viewer"));
+
+    QVERIFY(writeFile(m_userList, UserList));
+    QTRY_VERIFY(!index->handlers(QStringLiteral("text/plain")).contains(QStringLiteral("unwanted")));
+}
+
+QTEST_GUILESS_MAIN(tst_MimeHandlerIndex)
+#include "tst_mimehandlerindex.moc"
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "wayland/screencaststream.h"
+
+#include <QtTest>
+
+static QImage content()
+{
+    QImage image(640, 480, QImage::Format_RGB32);
+    image.fill(0xff336699u);
+    return image;
+}
+
+class tst_ScreenCastCursor : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void extract();
+    void hidden();
+    void contentChanged();
+    void sizeMismatch();
+};
+
+void tst_ScreenCastCursor::extract()
+{
+    const QImage plain = content();
+    QImage overlaid = plain;
+    // An arrow-like shape, the corners of its bounding box are untouched
+    for (int y = 0; y < 20; ++y) {
+        for (int x = 0; x <= y * 12 / 20; ++x)
+            overlaid.setPixel(100 + x, 50 + y, 0xff000000u | quint32(y));
+    }
+
+    ScreenCastCursor cursor;
+    QVERIFY(ScreenCastStream::extractCursor(plain, overlaid, &cursor));
+    QVERIFY(cursor.visible);
+    QCOMPARE(cursor.position, QPoint(100, 50));
+    QCOMPARE(cursor.hotspot, QPoint(0, 0));
+    QCOMPARE(cursor.bitmap.size(), QSize(12, 20));
+    QCOMPARE(cursor.bitmap.pixel(0, 19), 0xff000013u);
+    QCOMPARE(qAlpha(cursor.bitmap.pixel(11, 0)), 0);
+}
+
+void tst_ScreenCastCursor::hidden()
+{
+    ScreenCastCursor cursor;
+    cursor.visible = true;
+    QVERIFY(ScreenCastStream::extractCursor(content(), content(), &cursor));
+    QVERIFY(!cursor.visible);
+    QVERIFY(cursor.bitmap.isNull());
+}
+
+void tst_ScreenCastCursor::contentChanged()
+{
+    // A window moved between the two captures, that is no cursor
+    const QImage plain = content();
+    QImage overlaid = plain;
+    for (int y = 0; y < 300; ++y) {
+        for (int x = 0; x < 10; ++x)
+            overlaid.setPixel(x, y, 0xffffffffu);
+    }
+    ScreenCastCursor cursor;
+    QVERIFY(!ScreenCastStream::extractCursor(plain, overlaid, &cursor));
+    QVERIFY(!cursor.visible);
+}
+
+void tst_ScreenCastCursor::sizeMismatch()
+{
+    ScreenCastCursor cursor;
+    QVERIFY(!ScreenCastStream::extractCursor(content(), content().copy(0, 0, 320, 240), &cursor));
+}
+
+QTEST_GUILESS_MAIN(tst_ScreenCastCursor)
+
+#include "tst_screencastcursor.moc"